@@ -0,0 +1,109 @@
+// Amortized AI decisions. Each agent re-plans every `period` ticks, with
+// agents staggered so about n / period of them come due on any one tick
+// (re-spread whenever the period or the set of agents changes); between
+// plans an agent keeps steering towards the target it last chose.
+// Events that invalidate plans (a kick, a change of possession) mark agents
+// urgent so they re-plan on the next tick instead of waiting their turn.
+//
+// A per-tick time budget caps the planning work: urgent agents go first,
+// then the most overdue, and whoever does not fit waits for the next tick,
+// where having waited moves it up. At least one agent plans every tick, so
+// nobody starves when a single plan costs more than the whole budget.
+// Without a budget due agents plan in index order, which keeps headless
+// runs deterministic.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+struct AiScheduler {
+    static constexpr int CLOCK_EVERY = 4; // plans between clock reads
+
+    int period = 1;          // ticks between routine re-plans
+    float budgetUs = 0.0f;   // planning time per tick, 0 = unlimited
+
+    // Totals since the scheduler was created
+    uint64_t plans = 0, urgentPlans = 0, deferred = 0;
+    uint32_t maxLate = 0;    // most ticks a plan ran after it was due
+
+    void request(size_t i){ if(i < urgent.size()) urgent[i] = 1; }
+    void request_all(){ std::fill(urgent.begin(), urgent.end(), 1); }
+
+    // One tick: plan(i) for the agents that are due or urgent.
+    // isAgent(i): false for slots that do not plan (human players).
+    // Returns the number of plans run.
+    template<class IsAgent, class Plan>
+    int run(uint32_t tick, size_t n, IsAgent&& isAgent, Plan&& plan){
+        bool changed = next.size() != n || staggered != period;
+        if(next.size() != n){
+            next.assign(n, tick);
+            urgent.assign(n, 0);
+            agent.assign(n, 0);
+        }
+        for(size_t i = 0; i < n; ++i){
+            const uint8_t a = isAgent(i) ? 1 : 0;
+            if(a != agent[i]){ agent[i] = a; changed = true; }
+        }
+        if(changed) stagger(tick);
+        order.clear();
+        for(size_t i = 0; i < n; ++i){
+            if(!agent[i]){ urgent[i] = 0; continue; }
+            if(urgent[i] || (int32_t)(tick - next[i]) >= 0) order.push_back((uint32_t)i);
+        }
+        if(order.empty()) return 0;
+
+        using Clock = std::chrono::steady_clock;
+        const bool limited = budgetUs > 0.0f;
+        // Budgeted: a heap, so a tick that only fits a few plans does not sort everyone.
+        // Urgent first, then earliest due tick; index breaks ties
+        auto later = [&](uint32_t a, uint32_t b){
+            if(urgent[a] != urgent[b]) return urgent[a] < urgent[b];
+            int32_t da = (int32_t)(next[a] - tick), db = (int32_t)(next[b] - tick);
+            return da != db ? da > db : a > b;
+        };
+        if(limited) std::make_heap(order.begin(), order.end(), later);
+        const Clock::time_point start = limited ? Clock::now() : Clock::time_point();
+        const auto budget = std::chrono::duration<float, std::micro>(budgetUs);
+        const int count = (int)order.size();
+        int ran = 0;
+        for(; ran < count; ++ran){
+            if(limited && ran > 0 && ran % CLOCK_EVERY == 0 && Clock::now() - start >= budget){
+                deferred += count - ran;
+                break;
+            }
+            uint32_t i = order[ran];
+            if(limited){
+                std::pop_heap(order.begin(), order.end() - ran, later);
+                i = order[count - 1 - ran];
+            }
+            const int32_t late = (int32_t)(tick - next[i]);
+            if(late > 0) maxLate = std::max(maxLate, (uint32_t)late);
+            urgentPlans += urgent[i];
+            plan(i);
+            urgent[i] = 0;
+            next[i] = tick + (uint32_t)std::max(period, 1);
+        }
+        plans += ran;
+        return ran;
+    }
+
+private:
+    // Agents, their count or the period changed: everyone gets a fresh due
+    // tick, spread by rank among the agents rather than by slot index
+    void stagger(uint32_t tick){
+        const int p = std::max(period, 1);
+        uint32_t rank = 0;
+        for(size_t i = 0; i < next.size(); ++i){
+            if(agent[i]) next[i] = tick + rank++ % (uint32_t)p;
+        }
+        staggered = period;
+    }
+
+    std::vector<uint32_t> next;   // tick at which each agent plans again
+    std::vector<uint8_t> urgent;
+    std::vector<uint8_t> agent;   // isAgent(i) when last staggered
+    int staggered = 0;            // period the due ticks were spread over
+    std::vector<uint32_t> order;  // scratch: agents wanting to plan this tick
+};
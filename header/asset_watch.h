@@ -0,0 +1,187 @@
+// Asset hot reload: watches the files the game loaded and decodes the ones
+// that change on a worker thread. Linux uses inotify on each watched file's
+// directory (IN_CLOSE_WRITE, plus IN_MOVED_TO for editors that save through
+// a temp file and rename); other platforms poll modification times. Only
+// the decode happens on the worker: textures, fonts and the CPU raster
+// copies are patched by the main thread from take().
+#pragma once
+
+#include <SDL.h>
+#include <SDL_image.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "log.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+struct AssetChange {
+    std::string path;             // as passed to watch()
+    SDL_Surface* surf = nullptr;  // ARGB8888 for PNG/JPG, nullptr otherwise or on decode failure; caller frees
+};
+
+struct AssetWatcher {
+    static constexpr int POLL_MS = 250;
+    static constexpr int SETTLE_MS = 50; // coalesce the events of one save
+
+    ~AssetWatcher(){ stop(); }
+
+    // Any thread, before or after start()
+    void watch(const std::string& path){
+        std::lock_guard<std::mutex> lock(mtx);
+        std::string key = normalize(path);
+        if(files.count(key)) return;
+        files[key] = { path, mtime(path) };
+#ifdef __linux__
+        // "." for files in the working directory: events rebuild "./name", which normalizes to the key
+        std::string dir = std::filesystem::path(key).parent_path().string();
+        if(dir.empty()) dir = ".";
+        if(fd >= 0 && !watchedDirs.count(dir)){
+            int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if(wd >= 0){ dirs[wd] = dir; watchedDirs[dir] = wd; }
+        }
+#endif
+    }
+
+    bool start(){
+        if(worker.joinable()) return true;
+#ifdef __linux__
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(fd < 0) LOG_WARN("Hot reload: inotify unavailable, polling file times");
+        std::vector<std::string> paths;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for(auto& [key, f] : files) paths.push_back(f.path);
+            files.clear();
+        }
+        for(const std::string& p : paths) watch(p); // re-add directories to the new fd
+#endif
+        quit = false;
+        worker = std::thread([this]{ run(); });
+        return true;
+    }
+
+    void stop(){
+        if(!worker.joinable()) return;
+        quit = true;
+        worker.join();
+#ifdef __linux__
+        if(fd >= 0) close(fd);
+        fd = -1;
+        dirs.clear(); watchedDirs.clear();
+#endif
+        for(AssetChange& c : ready) if(c.surf) SDL_FreeSurface(c.surf);
+        ready.clear();
+    }
+
+    // Main thread: changes decoded since the last call
+    std::vector<AssetChange> take(){
+        std::lock_guard<std::mutex> lock(mtx);
+        std::vector<AssetChange> out;
+        out.swap(ready);
+        return out;
+    }
+
+private:
+    struct File {
+        std::string path;
+        std::filesystem::file_time_type time;
+    };
+
+    std::mutex mtx;
+    std::unordered_map<std::string, File> files; // normalized path -> file
+    std::vector<AssetChange> ready;
+    std::thread worker;
+    std::atomic<bool> quit{ false };
+#ifdef __linux__
+    int fd = -1;
+    std::unordered_map<int, std::string> dirs;        // wd -> dir
+    std::unordered_map<std::string, int> watchedDirs; // dir -> wd
+#endif
+
+    static std::string normalize(const std::string& path){
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+    static std::filesystem::file_time_type mtime(const std::string& path){
+        std::error_code ec;
+        auto t = std::filesystem::last_write_time(path, ec);
+        return ec ? std::filesystem::file_time_type{} : t;
+    }
+
+    static bool is_image(const std::string& path){
+        std::string ext = std::filesystem::path(path).extension().string();
+        for(char& ch : ext) ch = (char)tolower((unsigned char)ch);
+        return ext == ".png" || ext == ".jpg" || ext == ".jpeg";
+    }
+
+    void run(){
+        while(!quit){
+            std::vector<std::string> changed = wait_for_changes();
+            if(changed.empty()) continue;
+            std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_MS));
+            std::vector<std::string> more = wait_for_changes(0);
+            changed.insert(changed.end(), more.begin(), more.end());
+            std::sort(changed.begin(), changed.end());
+            changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+            for(const std::string& path : changed){
+                AssetChange c{ path, nullptr };
+                if(is_image(path)){
+                    if(SDL_Surface* raw = IMG_Load(path.c_str())){
+                        c.surf = SDL_ConvertSurfaceFormat(raw, SDL_PIXELFORMAT_ARGB8888, 0);
+                        SDL_FreeSurface(raw);
+                    }
+                }
+                std::lock_guard<std::mutex> lock(mtx);
+                ready.push_back(c);
+            }
+        }
+    }
+
+    // Watched paths (as given to watch()) that changed; waits up to timeoutMs
+    std::vector<std::string> wait_for_changes(int timeoutMs = POLL_MS){
+        std::vector<std::string> out;
+#ifdef __linux__
+        if(fd >= 0){
+            pollfd p = { fd, POLLIN, 0 };
+            if(poll(&p, 1, timeoutMs) <= 0) return out;
+            alignas(inotify_event) char buf[4096];
+            ssize_t n;
+            while((n = read(fd, buf, sizeof(buf))) > 0){
+                std::lock_guard<std::mutex> lock(mtx);
+                for(char* at = buf; at < buf + n; at += sizeof(inotify_event) + ((inotify_event*)at)->len){
+                    const inotify_event* ev = (const inotify_event*)at;
+                    auto dir = dirs.find(ev->wd);
+                    if(dir == dirs.end() || ev->len == 0) continue;
+                    std::string key = normalize(dir->second + "/" + ev->name);
+                    auto f = files.find(key);
+                    if(f != files.end()) out.push_back(f->second.path);
+                }
+            }
+            return out;
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        std::lock_guard<std::mutex> lock(mtx);
+        for(auto& [key, f] : files){
+            auto t = mtime(f.path);
+            if(t != f.time){ f.time = t; out.push_back(f.path); }
+        }
+        return out;
+    }
+};
@@ -0,0 +1,176 @@
+// Asynchronous environment stepping for training workloads. The caller
+// submits actions for any subset of environments and receives results in
+// the order the steps finish, so one slow environment (resetting after a
+// goal, a long physics tick) never holds back the rest of the batch.
+//
+// Jobs and results travel through bounded lock-free MPMC queues (Vyukov).
+// Idle workers and a caller waiting in recv() block on an atomic sequence
+// number (C++20 wait/notify) rather than a mutex. An environment is only
+// ever stepped by one worker at a time: it is owned by whoever holds its
+// job, and the caller must not touch it between submit() and its result.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Bounded multi-producer multi-consumer queue; capacity is a power of two
+template<class T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity){
+        size_t n = 2;
+        while(n < capacity) n <<= 1;
+        mask = n - 1;
+        cells = std::make_unique<Cell[]>(n);
+        for(size_t i = 0; i < n; ++i) cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(const T& v){
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for(;;){
+            Cell& c = cells[pos & mask];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if(diff == 0){
+                if(tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                    c.value = v;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if(diff < 0){
+                return false; // full
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(T& out){
+        size_t pos = head.load(std::memory_order_relaxed);
+        for(;;){
+            Cell& c = cells[pos & mask];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if(diff == 0){
+                if(head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                    out = c.value;
+                    c.seq.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if(diff < 0){
+                return false; // empty
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+};
+
+// Env must provide Action, Result and `void step(const Action&, Result&)`.
+// Result should carry the environment index so the caller can resubmit.
+template<class Env>
+class AsyncEnvPool {
+public:
+    using Action = typename Env::Action;
+    using Result = typename Env::Result;
+
+    // threads = 0: one per hardware thread
+    AsyncEnvPool(std::vector<std::unique_ptr<Env>> environments, int threads = 0)
+        : envs(std::move(environments)), jobs(envs.size()), results(envs.size()){
+        if(threads <= 0) threads = (int)std::thread::hardware_concurrency();
+        if(threads <= 0) threads = 1;
+        for(int i = 0; i < threads; ++i) workers.emplace_back([this]{ worker_loop(); });
+    }
+
+    ~AsyncEnvPool(){
+        quit.store(true, std::memory_order_relaxed);
+        jobSeq.fetch_add(1, std::memory_order_release);
+        jobSeq.notify_all();
+        for(auto &t : workers) t.join();
+    }
+
+    AsyncEnvPool(const AsyncEnvPool&) = delete;
+    AsyncEnvPool& operator=(const AsyncEnvPool&) = delete;
+
+    int size() const { return (int)envs.size(); }
+    int threads() const { return (int)workers.size(); }
+    int in_flight() const { return inFlight; }
+
+    // Environment `env` must not already be in flight
+    void submit(int env, const Action& action){
+        jobs.push(Job{ env, action }); // cannot fail: at most one job per environment
+        ++inFlight;
+        jobSeq.fetch_add(1, std::memory_order_release);
+        jobSeq.notify_one();
+    }
+
+    // Wait until at least minResults steps have finished (fewer if fewer are
+    // in flight), then return up to maxResults of them, earliest first
+    int recv(Result* out, int maxResults, int minResults = 1){
+        if(minResults > inFlight) minResults = inFlight;
+        int n = 0;
+        while(n < maxResults){
+            if(results.pop(out[n])){ ++n; --inFlight; continue; }
+            if(n >= minResults) break;
+            uint32_t seen = resultSeq.load(std::memory_order_acquire);
+            if(results.pop(out[n])){ ++n; --inFlight; continue; }
+            resultSeq.wait(seen, std::memory_order_acquire);
+        }
+        return n;
+    }
+
+    // Synchronous batch step, for comparison: every environment, wait for all
+    int step_all(const Action* actions, Result* out){
+        for(int i = 0; i < size(); ++i) submit(i, actions[i]);
+        return recv(out, size(), size());
+    }
+
+    // Only while the environment is not in flight
+    Env& env(int i){ return *envs[i]; }
+
+private:
+    struct Job {
+        int env = -1;
+        Action action{};
+    };
+
+    std::vector<std::unique_ptr<Env>> envs;
+    MpmcQueue<Job> jobs;
+    MpmcQueue<Result> results;
+    std::vector<std::thread> workers;
+    std::atomic<bool> quit{ false };
+    alignas(64) std::atomic<uint32_t> jobSeq{ 0 };
+    alignas(64) std::atomic<uint32_t> resultSeq{ 0 };
+    int inFlight = 0; // caller thread only
+
+    void worker_loop(){
+        Job job;
+        Result r;
+        for(;;){
+            uint32_t seen = jobSeq.load(std::memory_order_acquire);
+            if(!jobs.pop(job)){
+                if(quit.load(std::memory_order_relaxed)) return;
+                jobSeq.wait(seen, std::memory_order_acquire);
+                continue;
+            }
+            envs[job.env]->step(job.action, r);
+            results.push(r); // cannot fail: results never exceed environments
+            resultSeq.fetch_add(1, std::memory_order_release);
+            resultSeq.notify_one();
+        }
+    }
+};
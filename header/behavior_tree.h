@@ -0,0 +1,236 @@
+// Behavior trees authored as indented text and compiled at load time into a
+// flat array of 16-byte instructions in pre-order. Every node records the
+// index one past its subtree, so the interpreter walks the array with a
+// small stack of open composites and skips a subtree by jumping to `end`.
+// Per tick it runs no recursion, no virtual calls and no allocation.
+//
+// Source format, one node per line, children indented under their parent:
+//
+//     # comment
+//     selector
+//       cooldown 1.5
+//         kick
+//       track_ball_y
+//
+// Built-in nodes: sequence, selector (one or more children), invert,
+// succeed, cooldown SECONDS (exactly one child). Every other name must be a
+// leaf of the table the host passes to compile(); the host evaluates leaves
+// by id. Trees are reactive: they re-run from the root on every tick and
+// sequence/selector keep no running child.
+//
+// Nodes that keep state (cooldown) get a blackboard slot at compile time.
+// One agent's slots are `slots` consecutive floats, so a team's blackboard
+// is a single array of agents x slots. Slots start at zero.
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+enum BtStatus : uint8_t { BT_FAILURE, BT_SUCCESS, BT_RUNNING };
+
+enum BtOp : uint8_t { BT_LEAF, BT_SEQUENCE, BT_SELECTOR, BT_INVERT, BT_SUCCEED, BT_COOLDOWN };
+
+struct BtInstr {
+    uint8_t op;      // BtOp
+    uint8_t leaf;    // host leaf id (BT_LEAF)
+    uint16_t slot;   // blackboard slot of stateful nodes
+    uint16_t end;    // index one past this node's subtree
+    uint16_t line;   // source line, for error messages and debugging
+    float arg[2];
+};
+static_assert(sizeof(BtInstr) == 16, "BtInstr should stay 16 bytes");
+
+// Leaf table entry: name in the source and accepted argument count
+struct BtLeafDef {
+    const char* name;
+    int minArgs, maxArgs;
+};
+
+struct BtProgram {
+    static constexpr int MAX_DEPTH = 32;
+    static constexpr int MAX_ARGS = 2;
+
+    std::vector<BtInstr> code;
+    int slots = 0;
+
+    bool empty() const { return code.empty(); }
+
+    // Same instructions and slots; source lines (comments, blank lines) may differ
+    bool same_code(const BtProgram& other) const {
+        if(slots != other.slots || code.size() != other.code.size()) return false;
+        for(size_t i = 0; i < code.size(); ++i){
+            const BtInstr& a = code[i];
+            const BtInstr& b = other.code[i];
+            if(a.op != b.op || a.leaf != b.leaf || a.slot != b.slot || a.end != b.end ||
+               a.arg[0] != b.arg[0] || a.arg[1] != b.arg[1]) return false;
+        }
+        return true;
+    }
+
+    // On failure the program is left unchanged and error holds "name:line: reason"
+    bool compile(const char* src, const BtLeafDef* leaves, int leafCount, std::string& error, const char* name = "tree"){
+        struct Node {
+            int op = BT_LEAF, leaf = 0, line = 0, argc = 0;
+            float arg[MAX_ARGS] = {};
+            std::vector<int> children;
+        };
+        std::vector<Node> nodes;
+        struct Open { int indent, node; };
+        std::vector<Open> open;
+        auto fail = [&](int line, const char* what, const char* detail = ""){
+            char buf[256];
+            snprintf(buf, sizeof(buf), "%s:%d: %s%s", name, line, what, detail);
+            error = buf;
+            return false;
+        };
+
+        int lineNo = 0;
+        for(const char* p = src; *p; ){
+            const char* eol = strchr(p, '\n');
+            if(!eol) eol = p + strlen(p);
+            std::string text(p, eol);
+            p = *eol ? eol + 1 : eol;
+            ++lineNo;
+
+            size_t hash = text.find('#');
+            if(hash != std::string::npos) text.resize(hash);
+            int indent = 0;
+            while(indent < (int)text.size() && text[indent] == ' ') ++indent;
+            if(indent < (int)text.size() && text[indent] == '\t') return fail(lineNo, "indent with spaces, not tabs");
+
+            std::vector<std::string> tok;
+            for(size_t i = indent; i < text.size(); ){
+                while(i < text.size() && isspace((unsigned char)text[i])) ++i;
+                size_t j = i;
+                while(j < text.size() && !isspace((unsigned char)text[j])) ++j;
+                if(j > i) tok.emplace_back(text, i, j - i);
+                i = j;
+            }
+            if(tok.empty()) continue;
+
+            Node n;
+            n.line = lineNo;
+            int minArgs = 0, maxArgs = 0;
+            const std::string& word = tok[0];
+            if(word == "sequence") n.op = BT_SEQUENCE;
+            else if(word == "selector") n.op = BT_SELECTOR;
+            else if(word == "invert") n.op = BT_INVERT;
+            else if(word == "succeed") n.op = BT_SUCCEED;
+            else if(word == "cooldown"){ n.op = BT_COOLDOWN; minArgs = maxArgs = 1; }
+            else {
+                int id = 0;
+                while(id < leafCount && word != leaves[id].name) ++id;
+                if(id == leafCount) return fail(lineNo, "unknown node ", word.c_str());
+                n.leaf = id;
+                minArgs = leaves[id].minArgs;
+                maxArgs = leaves[id].maxArgs;
+            }
+            n.argc = (int)tok.size() - 1;
+            if(n.argc < minArgs || n.argc > maxArgs || n.argc > MAX_ARGS) return fail(lineNo, "wrong number of arguments for ", word.c_str());
+            for(int a = 0; a < n.argc; ++a){
+                char* endp = nullptr;
+                n.arg[a] = strtof(tok[a + 1].c_str(), &endp);
+                if(*endp) return fail(lineNo, "not a number: ", tok[a + 1].c_str());
+            }
+            if(n.op == BT_COOLDOWN && !(n.arg[0] > 0.0f)) return fail(lineNo, "cooldown needs a positive number of seconds");
+
+            while(!open.empty() && open.back().indent >= indent) open.pop_back();
+            int self = (int)nodes.size();
+            if(open.empty()){
+                if(!nodes.empty()) return fail(lineNo, "a tree has a single root");
+            } else {
+                Node& parent = nodes[open.back().node];
+                if(parent.op == BT_LEAF) return fail(lineNo, "leaves cannot have children");
+                parent.children.push_back(self);
+            }
+            if((int)open.size() >= MAX_DEPTH) return fail(lineNo, "tree too deep");
+            nodes.push_back(std::move(n));
+            open.push_back({ indent, self });
+        }
+        if(nodes.empty()) return fail(lineNo, "empty tree");
+
+        for(const Node& n : nodes){
+            size_t c = n.children.size();
+            bool decorator = n.op == BT_INVERT || n.op == BT_SUCCEED || n.op == BT_COOLDOWN;
+            if(decorator && c != 1) return fail(n.line, "decorators take exactly one child");
+            if((n.op == BT_SEQUENCE || n.op == BT_SELECTOR) && c == 0) return fail(n.line, "composites need at least one child");
+        }
+        if(nodes.size() > 0xFFFF) return fail(lineNo, "tree too large");
+
+        // Pre-order emit; children were appended in source order
+        std::vector<BtInstr> out;
+        out.reserve(nodes.size());
+        int slotCount = 0;
+        auto emit = [&](auto&& self, int idx) -> void {
+            const Node& n = nodes[idx];
+            size_t at = out.size();
+            BtInstr in = {};
+            in.op = (uint8_t)n.op;
+            in.leaf = (uint8_t)n.leaf;
+            in.slot = n.op == BT_COOLDOWN ? (uint16_t)slotCount++ : 0;
+            in.line = (uint16_t)n.line;
+            in.arg[0] = n.arg[0];
+            in.arg[1] = n.arg[1];
+            out.push_back(in);
+            for(int c : n.children) self(self, c);
+            out[at].end = (uint16_t)out.size();
+        };
+        emit(emit, 0);
+
+        code = std::move(out);
+        slots = slotCount;
+        error.clear();
+        return true;
+    }
+
+    bool load(const char* path, const BtLeafDef* leaves, int leafCount, std::string& error){
+        FILE* f = fopen(path, "rb");
+        if(!f){ error = std::string(path) + ": cannot open"; return false; }
+        std::string src;
+        char buf[4096];
+        size_t n;
+        while((n = fread(buf, 1, sizeof(buf), f)) > 0) src.append(buf, n);
+        fclose(f);
+        return compile(src.c_str(), leaves, leafCount, error, path);
+    }
+};
+
+// One tick of the tree for one agent. slots: that agent's prog.slots floats;
+// now: seconds on a clock that only moves forward (cooldowns).
+// Host: BtStatus leaf(const BtInstr&).
+template<class Host>
+BtStatus bt_tick(const BtProgram& prog, float* slots, float now, Host& host){
+    const BtInstr* code = prog.code.data();
+    int stack[BtProgram::MAX_DEPTH];
+    int sp = 0, pc = 0;
+    BtStatus s;
+    for(;;){
+        // Descend into pc until a node finishes
+        const BtInstr& in = code[pc];
+        if(in.op == BT_LEAF) s = host.leaf(in);
+        else if(in.op == BT_COOLDOWN && now < slots[in.slot]) s = BT_FAILURE;
+        else { stack[sp++] = pc++; continue; }
+
+        // Hand the status of pc to its parents until one has another child to run
+        for(;;){
+            if(sp == 0) return s;
+            const int parent = stack[sp - 1];
+            const BtInstr& p = code[parent];
+            const int next = code[pc].end;
+            if(next < p.end && ((p.op == BT_SEQUENCE && s == BT_SUCCESS) || (p.op == BT_SELECTOR && s == BT_FAILURE))){
+                pc = next;
+                break;
+            }
+            if(p.op == BT_INVERT && s != BT_RUNNING) s = s == BT_SUCCESS ? BT_FAILURE : BT_SUCCESS;
+            else if(p.op == BT_SUCCEED && s == BT_FAILURE) s = BT_SUCCESS;
+            else if(p.op == BT_COOLDOWN && s == BT_SUCCESS) slots[p.slot] = now + p.arg[0];
+            pc = parent;
+            --sp;
+        }
+    }
+}
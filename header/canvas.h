@@ -0,0 +1,88 @@
+// Where world drawing goes: straight to the SDL_Renderer, or recorded into a
+// CpuDrawList for the CPU rasterizer (cpu_renderer.h). Tint and alpha are
+// passed per call rather than left on the texture, so draw code never
+// depends on state set by an earlier draw.
+#pragma once
+
+#include <SDL.h>
+
+#include "cpu_renderer.h"
+
+struct Canvas {
+    SDL_Renderer* renderer = nullptr;
+    CpuDrawList* list = nullptr;          // non-null: record instead of drawing
+    const CpuImageMap* images = nullptr;  // texture -> CPU copy, for recorded sprites
+
+    static constexpr SDL_Color WHITE = { 255, 255, 255, 255 };
+
+    void clear(){
+        if(!list) SDL_RenderClear(renderer);
+    }
+
+    void copy_ex(SDL_Texture* tex, const SDL_Rect* src, const SDL_Rect* dst, double angle,
+                 const SDL_Point* center, SDL_RendererFlip flip, SDL_Color tint = WHITE){
+        if(!tex || !dst) return;
+        if(list){
+            if(!images) return;
+            auto it = images->find(tex);
+            if(it == images->end()) return;
+            float px = center ? (float)center->x : dst->w * 0.5f;
+            float py = center ? (float)center->y : dst->h * 0.5f;
+            list->sprite(&it->second, src, (float)dst->x, (float)dst->y, (float)dst->w, (float)dst->h,
+                         angle, px, py, flip, tint);
+            return;
+        }
+        SDL_SetTextureColorMod(tex, tint.r, tint.g, tint.b);
+        SDL_SetTextureAlphaMod(tex, tint.a);
+        SDL_RenderCopyEx(renderer, tex, src, dst, angle, center, flip);
+    }
+
+    void copy(SDL_Texture* tex, const SDL_Rect* dst, SDL_Color tint = WHITE){
+        copy_ex(tex, nullptr, dst, 0.0, nullptr, SDL_FLIP_NONE, tint);
+    }
+
+    void fill_rect(const SDL_Rect& r, SDL_Color c){
+        if(list){ list->fill((float)r.x, (float)r.y, (float)r.w, (float)r.h, c); return; }
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+        SDL_RenderFillRect(renderer, &r);
+    }
+
+    void fill_rects(const SDL_FRect* rects, int n, SDL_Color c){
+        if(list){
+            for(int i = 0; i < n; ++i) list->fill(rects[i].x, rects[i].y, rects[i].w, rects[i].h, c);
+            return;
+        }
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+        SDL_RenderFillRectsF(renderer, rects, n);
+    }
+
+    // 1px outline
+    void draw_rect(const SDL_Rect& r, SDL_Color c){
+        if(list){
+            list->fill((float)r.x, (float)r.y, (float)r.w, 1.0f, c);
+            list->fill((float)r.x, (float)(r.y + r.h - 1), (float)r.w, 1.0f, c);
+            list->fill((float)r.x, (float)(r.y + 1), 1.0f, (float)(r.h - 2), c);
+            list->fill((float)(r.x + r.w - 1), (float)(r.y + 1), 1.0f, (float)(r.h - 2), c);
+            return;
+        }
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+        SDL_RenderDrawRect(renderer, &r);
+    }
+
+    // Untextured triangles, indexed or not
+    void geometry(const SDL_Vertex* verts, int numVerts, const int* indices, int numIndices){
+        if(list){
+            if(indices){
+                for(int i = 0; i + 2 < numIndices; i += 3) list->triangle(verts[indices[i]], verts[indices[i + 1]], verts[indices[i + 2]]);
+            } else {
+                for(int i = 0; i + 2 < numVerts; i += 3) list->triangle(verts[i], verts[i + 1], verts[i + 2]);
+            }
+            return;
+        }
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_RenderGeometry(renderer, nullptr, verts, numVerts, indices, numIndices);
+    }
+};
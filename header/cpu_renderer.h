@@ -0,0 +1,471 @@
+// CPU rasterizer for machines without a usable GPU (--cpu-raster).
+// A frame is recorded as a draw list (rotated / tinted / alpha sprites,
+// solid rects, vertex-colored triangles) and rasterized in 64x64 tiles
+// spread over a ThreadPool. Every tile walks the list in order, so layering
+// is the same as the SDL path. Sprite and rect spans are blended 4 pixels
+// at a time with SSE2, or 8 with AVX2 when the CPU reports it at runtime.
+// Images are stored premultiplied; sampling is nearest, like the SDL path
+// with the default scale quality.
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "thread_pool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TF_CPU_RASTER_SSE2 1
+#endif
+
+// AVX2 kernel compiled with a target attribute and picked at runtime.
+// Not on Windows: GCC cannot realign the stack for 32-byte spills there.
+#if defined(TF_CPU_RASTER_SSE2) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__) && !defined(_WIN32)
+#include <immintrin.h>
+#define TF_CPU_RASTER_AVX2 1
+#define TF_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+struct CpuImage {
+    int w = 0, h = 0;
+    std::vector<uint32_t> px; // premultiplied ARGB8888
+};
+
+using CpuImageMap = std::unordered_map<SDL_Texture*, CpuImage>;
+
+// Copy any surface into a premultiplied CpuImage
+inline bool cpu_image_from_surface(CpuImage& img, SDL_Surface* surf){
+    SDL_Surface* conv = SDL_ConvertSurfaceFormat(surf, SDL_PIXELFORMAT_ARGB8888, 0);
+    if(!conv) return false;
+    img.w = conv->w;
+    img.h = conv->h;
+    img.px.resize((size_t)img.w * img.h);
+    SDL_LockSurface(conv);
+    for(int y = 0; y < img.h; ++y){
+        const uint32_t* row = (const uint32_t*)((const uint8_t*)conv->pixels + (size_t)y * conv->pitch);
+        uint32_t* out = &img.px[(size_t)y * img.w];
+        for(int x = 0; x < img.w; ++x){
+            uint32_t p = row[x], a = p >> 24;
+            uint32_t r = ((p >> 16) & 255) * a / 255, g = ((p >> 8) & 255) * a / 255, b = (p & 255) * a / 255;
+            out[x] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+    SDL_UnlockSurface(conv);
+    SDL_FreeSurface(conv);
+    return true;
+}
+
+struct CpuCmd {
+    enum Kind : uint8_t { FILL, SPRITE, TRIANGLE };
+    Kind kind;
+    int x0, y0, x1, y1;  // pixel bounds [x0,x1) x [y0,y1), clipped to the target
+    uint32_t color;      // FILL: premultiplied color; SPRITE: premultiplied tint (0xFFFFFFFF = none)
+
+    // SPRITE: screen pixel center -> texel, u = m[0]x + m[1]y + m[2], v = m[3]x + m[4]y + m[5]
+    const CpuImage* img;
+    int srcX, srcY, srcW, srcH;
+    float m[6];
+
+    // TRIANGLE
+    float tx[3], ty[3];
+    SDL_Color tc[3];
+};
+
+namespace cpu_raster {
+
+inline uint32_t div255(uint32_t x){ x += 128; return (x + (x >> 8)) >> 8; }
+
+inline uint32_t premultiply(SDL_Color c){
+    return ((uint32_t)c.a << 24) | (div255(c.r * c.a) << 16) | (div255(c.g * c.a) << 8) | div255(c.b * c.a);
+}
+
+// Per-channel multiply, both premultiplied
+inline uint32_t modulate(uint32_t p, uint32_t m){
+    return (div255((p >> 24) * (m >> 24)) << 24)
+         | (div255(((p >> 16) & 255) * ((m >> 16) & 255)) << 16)
+         | (div255(((p >> 8) & 255) * ((m >> 8) & 255)) << 8)
+         |  div255((p & 255) * (m & 255));
+}
+
+// src over dst, premultiplied
+inline uint32_t over(uint32_t dst, uint32_t src){
+    uint32_t sa = src >> 24;
+    if(sa == 255) return src;
+    if(sa == 0) return dst;
+    uint32_t inv = 255 - sa;
+    uint32_t rb = (dst & 0x00FF00FFu) * inv + 0x00800080u;
+    rb = ((rb + ((rb >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+    uint32_t ag = ((dst >> 8) & 0x00FF00FFu) * inv + 0x00800080u;
+    ag = (ag + ((ag >> 8) & 0x00FF00FFu)) & 0xFF00FF00u;
+    return src + (rb | ag);
+}
+
+inline uint32_t sample(const CpuCmd& c, float u, float v){
+    if(u < 0.0f || v < 0.0f || u >= (float)c.srcW || v >= (float)c.srcH) return 0;
+    return c.img->px[(size_t)(c.srcY + (int)v) * c.img->w + c.srcX + (int)u];
+}
+
+#ifdef TF_CPU_RASTER_SSE2
+inline __m128i div255_epi16(__m128i x){
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// 4 pixels; m16 = one pixel's multipliers as 16-bit b,g,r,a repeated twice
+inline __m128i modulate4(__m128i src, __m128i m16){
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = div255_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), m16));
+    __m128i hi = div255_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), m16));
+    return _mm_packus_epi16(lo, hi);
+}
+
+inline __m128i over4(__m128i dst, __m128i src){
+    const __m128i zero = _mm_setzero_si128();
+    __m128i inv = _mm_sub_epi32(_mm_set1_epi32(255), _mm_srli_epi32(src, 24));
+    inv = _mm_or_si128(inv, _mm_slli_epi32(inv, 16));
+    __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_unpacklo_epi32(inv, inv));
+    __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_unpackhi_epi32(inv, inv));
+    return _mm_add_epi8(src, _mm_packus_epi16(div255_epi16(lo), div255_epi16(hi)));
+}
+
+inline __m128i tint_epi16(uint32_t m){
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi8(_mm_set1_epi32((int)m), zero);
+}
+#endif
+
+#ifdef TF_CPU_RASTER_AVX2
+TF_TARGET_AVX2 inline __m256i div255_epi16_avx2(__m256i x){
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+// 8-pixel sprite span: gathered texels, tint, blend
+TF_TARGET_AVX2 inline int sprite_span_avx2(uint32_t* d, int n, float u, float v, const CpuCmd& c){
+    const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 du8 = _mm256_set1_ps(c.m[0] * 8), dv8 = _mm256_set1_ps(c.m[3] * 8);
+    const __m256 fzero = _mm256_setzero_ps();
+    const __m256 maxU = _mm256_set1_ps((float)c.srcW), maxV = _mm256_set1_ps((float)c.srcH);
+    const __m256i offX = _mm256_set1_epi32(c.srcX), offY = _mm256_set1_epi32(c.srcY);
+    const __m256i pitch = _mm256_set1_epi32(c.img->w);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i m16 = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)c.color), zero);
+    const bool tinted = c.color != 0xFFFFFFFFu;
+    const int* base = (const int*)c.img->px.data();
+
+    __m256 uu = _mm256_add_ps(_mm256_set1_ps(u), _mm256_mul_ps(_mm256_set1_ps(c.m[0]), lane));
+    __m256 vv = _mm256_add_ps(_mm256_set1_ps(v), _mm256_mul_ps(_mm256_set1_ps(c.m[3]), lane));
+    int i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(uu, fzero, _CMP_GE_OQ), _mm256_cmp_ps(uu, maxU, _CMP_LT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(vv, fzero, _CMP_GE_OQ), _mm256_cmp_ps(vv, maxV, _CMP_LT_OQ)));
+        if(_mm256_movemask_ps(inside)){
+            __m256i idx = _mm256_add_epi32(
+                _mm256_mullo_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(vv), offY), pitch),
+                _mm256_add_epi32(_mm256_cvttps_epi32(uu), offX));
+            __m256i s = _mm256_mask_i32gather_epi32(zero, base, idx, _mm256_castps_si256(inside), 4);
+            if(tinted){
+                __m256i lo = div255_epi16_avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), m16));
+                __m256i hi = div255_epi16_avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), m16));
+                s = _mm256_packus_epi16(lo, hi);
+            }
+            __m256i dd = _mm256_loadu_si256((const __m256i*)(d + i));
+            __m256i inv = _mm256_sub_epi32(_mm256_set1_epi32(255), _mm256_srli_epi32(s, 24));
+            inv = _mm256_or_si256(inv, _mm256_slli_epi32(inv, 16));
+            __m256i lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(dd, zero), _mm256_unpacklo_epi32(inv, inv));
+            __m256i hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(dd, zero), _mm256_unpackhi_epi32(inv, inv));
+            dd = _mm256_add_epi8(s, _mm256_packus_epi16(div255_epi16_avx2(lo), div255_epi16_avx2(hi)));
+            _mm256_storeu_si256((__m256i*)(d + i), dd);
+        }
+        uu = _mm256_add_ps(uu, du8);
+        vv = _mm256_add_ps(vv, dv8);
+    }
+    return i;
+}
+#endif
+
+// One row of a sprite, u and v taken at the first pixel center
+inline void sprite_span(uint32_t* d, int n, float u, float v, const CpuCmd& c, bool avx2){
+    const float du = c.m[0], dv = c.m[3];
+    const bool tinted = c.color != 0xFFFFFFFFu;
+    int i = 0;
+#ifdef TF_CPU_RASTER_AVX2
+    if(avx2) i = sprite_span_avx2(d, n, u, v, c);
+#else
+    (void)avx2;
+#endif
+#ifdef TF_CPU_RASTER_SSE2
+    const __m128 lane = _mm_setr_ps(0, 1, 2, 3);
+    const __m128 fzero = _mm_setzero_ps();
+    const __m128 maxU = _mm_set1_ps((float)c.srcW), maxV = _mm_set1_ps((float)c.srcH);
+    const __m128i m16 = tint_epi16(c.color);
+    __m128 uu = _mm_add_ps(_mm_set1_ps(u + du * i), _mm_mul_ps(_mm_set1_ps(du), lane));
+    __m128 vv = _mm_add_ps(_mm_set1_ps(v + dv * i), _mm_mul_ps(_mm_set1_ps(dv), lane));
+    const __m128 du4 = _mm_set1_ps(du * 4), dv4 = _mm_set1_ps(dv * 4);
+    for(; i + 4 <= n; i += 4){
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(uu, fzero), _mm_cmplt_ps(uu, maxU)),
+                                   _mm_and_ps(_mm_cmpge_ps(vv, fzero), _mm_cmplt_ps(vv, maxV)));
+        int mask = _mm_movemask_ps(inside);
+        if(mask){
+            alignas(16) int32_t iu[4], iv[4];
+            alignas(16) uint32_t texel[4];
+            _mm_store_si128((__m128i*)iu, _mm_cvttps_epi32(uu));
+            _mm_store_si128((__m128i*)iv, _mm_cvttps_epi32(vv));
+            for(int k = 0; k < 4; ++k){
+                texel[k] = (mask >> k) & 1 ? c.img->px[(size_t)(c.srcY + iv[k]) * c.img->w + c.srcX + iu[k]] : 0;
+            }
+            __m128i s = _mm_load_si128((const __m128i*)texel);
+            if(tinted) s = modulate4(s, m16);
+            __m128i dd = _mm_loadu_si128((const __m128i*)(d + i));
+            _mm_storeu_si128((__m128i*)(d + i), over4(dd, s));
+        }
+        uu = _mm_add_ps(uu, du4);
+        vv = _mm_add_ps(vv, dv4);
+    }
+#endif
+    for(; i < n; ++i){
+        uint32_t s = sample(c, u + du * i, v + dv * i);
+        if(!s) continue;
+        if(tinted) s = modulate(s, c.color);
+        d[i] = over(d[i], s);
+    }
+}
+
+inline void fill_span(uint32_t* d, int n, uint32_t color){
+    if((color >> 24) == 255){
+        std::fill(d, d + n, color);
+        return;
+    }
+    int i = 0;
+#ifdef TF_CPU_RASTER_SSE2
+    const __m128i s = _mm_set1_epi32((int)color);
+    for(; i + 4 <= n; i += 4){
+        __m128i dd = _mm_loadu_si128((const __m128i*)(d + i));
+        _mm_storeu_si128((__m128i*)(d + i), over4(dd, s));
+    }
+#endif
+    for(; i < n; ++i) d[i] = over(d[i], color);
+}
+
+// Vertex-colored triangle, barycentric interpolation at pixel centers
+inline void triangle_rows(const CpuCmd& c, uint32_t* dst, int stride, int x0, int y0, int x1, int y1){
+    const float* X = c.tx;
+    const float* Y = c.ty;
+    float area = (X[1] - X[0]) * (Y[2] - Y[0]) - (Y[1] - Y[0]) * (X[2] - X[0]);
+    if(std::fabs(area) < 1e-6f) return;
+    const float inv = 1.0f / area;
+
+    // weight of vertex i = edge function of the opposite edge / area
+    float A[3], B[3], C[3];
+    for(int i = 0; i < 3; ++i){
+        int j = (i + 1) % 3, k = (i + 2) % 3;
+        A[i] = -(Y[k] - Y[j]) * inv;
+        B[i] =  (X[k] - X[j]) * inv;
+        C[i] = ((Y[k] - Y[j]) * X[j] - (X[k] - X[j]) * Y[j]) * inv;
+    }
+
+    for(int y = y0; y < y1; ++y){
+        float py = y + 0.5f, px = x0 + 0.5f;
+        float w0 = A[0] * px + B[0] * py + C[0];
+        float w1 = A[1] * px + B[1] * py + C[1];
+        float w2 = A[2] * px + B[2] * py + C[2];
+        uint32_t* d = dst + (size_t)y * stride;
+        for(int x = x0; x < x1; ++x, w0 += A[0], w1 += A[1], w2 += A[2]){
+            if(w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+            SDL_Color col = {
+                (Uint8)(w0 * c.tc[0].r + w1 * c.tc[1].r + w2 * c.tc[2].r + 0.5f),
+                (Uint8)(w0 * c.tc[0].g + w1 * c.tc[1].g + w2 * c.tc[2].g + 0.5f),
+                (Uint8)(w0 * c.tc[0].b + w1 * c.tc[1].b + w2 * c.tc[2].b + 0.5f),
+                (Uint8)(w0 * c.tc[0].a + w1 * c.tc[1].a + w2 * c.tc[2].a + 0.5f)
+            };
+            if(col.a) d[x] = over(d[x], premultiply(col));
+        }
+    }
+}
+
+} // namespace cpu_raster
+
+// One frame's worth of commands. Coordinates are recorded in game units,
+// multiplied by `scale` and shifted by the origin, so the same draw code can
+// target other resolutions (letterboxed inside a larger frame).
+struct CpuDrawList {
+    int width = 0, height = 0;   // viewport, in output pixels; nothing is drawn outside it
+    int originX = 0, originY = 0; // viewport's top-left in the output frame
+    float scale = 1.0f;
+    std::vector<CpuCmd> cmds;
+
+    void reset(int w, int h, float s = 1.0f, int ox = 0, int oy = 0){
+        width = w; height = h; scale = s;
+        originX = ox; originY = oy;
+        cmds.clear();
+    }
+
+    void fill(float x, float y, float w, float h, SDL_Color c){
+        if(c.a == 0 || w <= 0 || h <= 0) return;
+        CpuCmd cmd{};
+        cmd.kind = CpuCmd::FILL;
+        cmd.color = cpu_raster::premultiply(c);
+        // pixels whose center lies inside the rect
+        if(!clip(cmd, std::ceil(x * scale - 0.5f) + originX, std::ceil(y * scale - 0.5f) + originY,
+                      std::ceil((x + w) * scale - 0.5f) + originX, std::ceil((y + h) * scale - 0.5f) + originY)) return;
+        cmds.push_back(cmd);
+    }
+
+    // dst rect rotated by angle (degrees, clockwise) around pivot (relative to dst)
+    void sprite(const CpuImage* img, const SDL_Rect* src, float dx, float dy, float dw, float dh,
+                double angle, float pivotX, float pivotY, SDL_RendererFlip flip, SDL_Color tint){
+        if(!img || img->px.empty() || tint.a == 0 || dw <= 0 || dh <= 0) return;
+        CpuCmd cmd{};
+        cmd.kind = CpuCmd::SPRITE;
+        cmd.img = img;
+        SDL_Rect full = { 0, 0, img->w, img->h };
+        SDL_Rect s = src ? *src : full;
+        cmd.srcX = s.x; cmd.srcY = s.y; cmd.srcW = s.w; cmd.srcH = s.h;
+        if(tint.r == 255 && tint.g == 255 && tint.b == 255 && tint.a == 255) cmd.color = 0xFFFFFFFFu;
+        else cmd.color = cpu_raster::premultiply(tint);
+
+        dx = dx * scale + originX; dy = dy * scale + originY;
+        dw *= scale; dh *= scale; pivotX *= scale; pivotY *= scale;
+        const float rad = (float)(angle * 0.017453292519943295);
+        const float cs = std::cos(rad), sn = std::sin(rad);
+        const float ox = dx + pivotX, oy = dy + pivotY;
+        const float kx = s.w / dw, ky = s.h / dh;
+        cmd.m[0] = kx * cs;  cmd.m[1] = kx * sn; cmd.m[2] = kx * (pivotX - cs * ox - sn * oy);
+        cmd.m[3] = -ky * sn; cmd.m[4] = ky * cs; cmd.m[5] = ky * (pivotY + sn * ox - cs * oy);
+        if(flip & SDL_FLIP_HORIZONTAL){ cmd.m[0] = -cmd.m[0]; cmd.m[1] = -cmd.m[1]; cmd.m[2] = s.w - cmd.m[2]; }
+        if(flip & SDL_FLIP_VERTICAL){   cmd.m[3] = -cmd.m[3]; cmd.m[4] = -cmd.m[4]; cmd.m[5] = s.h - cmd.m[5]; }
+
+        float minX = 1e9f, minY = 1e9f, maxX = -1e9f, maxY = -1e9f;
+        for(int k = 0; k < 4; ++k){
+            float lx = (k & 1 ? dw : 0.0f) - pivotX, ly = (k & 2 ? dh : 0.0f) - pivotY;
+            float sx = ox + cs * lx - sn * ly, sy = oy + sn * lx + cs * ly;
+            minX = std::min(minX, sx); maxX = std::max(maxX, sx);
+            minY = std::min(minY, sy); maxY = std::max(maxY, sy);
+        }
+        if(!clip(cmd, std::floor(minX), std::floor(minY), std::ceil(maxX), std::ceil(maxY))) return;
+        cmds.push_back(cmd);
+    }
+
+    void triangle(const SDL_Vertex& a, const SDL_Vertex& b, const SDL_Vertex& c){
+        if(a.color.a == 0 && b.color.a == 0 && c.color.a == 0) return;
+        CpuCmd cmd{};
+        cmd.kind = CpuCmd::TRIANGLE;
+        const SDL_Vertex* v[3] = { &a, &b, &c };
+        for(int i = 0; i < 3; ++i){
+            cmd.tx[i] = v[i]->position.x * scale + originX;
+            cmd.ty[i] = v[i]->position.y * scale + originY;
+            cmd.tc[i] = v[i]->color;
+        }
+        if(!clip(cmd, std::floor(std::min({ cmd.tx[0], cmd.tx[1], cmd.tx[2] })),
+                      std::floor(std::min({ cmd.ty[0], cmd.ty[1], cmd.ty[2] })),
+                      std::ceil(std::max({ cmd.tx[0], cmd.tx[1], cmd.tx[2] })),
+                      std::ceil(std::max({ cmd.ty[0], cmd.ty[1], cmd.ty[2] })))) return;
+        cmds.push_back(cmd);
+    }
+
+    // Rasterize the part of the list inside `region` into dst (full-frame
+    // buffer, stride in pixels). Independent regions can run in parallel.
+    void raster(uint32_t* dst, int stride, const SDL_Rect& region, bool avx2) const {
+        const int rx1 = region.x + region.w, ry1 = region.y + region.h;
+        for(int y = region.y; y < ry1; ++y) std::fill(dst + (size_t)y * stride + region.x, dst + (size_t)y * stride + rx1, 0xFF000000u);
+
+        for(const CpuCmd& c : cmds){
+            int x0 = std::max(c.x0, region.x), x1 = std::min(c.x1, rx1);
+            int y0 = std::max(c.y0, region.y), y1 = std::min(c.y1, ry1);
+            if(x0 >= x1 || y0 >= y1) continue;
+            switch(c.kind){
+                case CpuCmd::FILL:
+                    for(int y = y0; y < y1; ++y) cpu_raster::fill_span(dst + (size_t)y * stride + x0, x1 - x0, c.color);
+                    break;
+                case CpuCmd::SPRITE:
+                    for(int y = y0; y < y1; ++y){
+                        float px = x0 + 0.5f, py = y + 0.5f;
+                        float u = c.m[0] * px + c.m[1] * py + c.m[2];
+                        float v = c.m[3] * px + c.m[4] * py + c.m[5];
+                        cpu_raster::sprite_span(dst + (size_t)y * stride + x0, x1 - x0, u, v, c, avx2);
+                    }
+                    break;
+                case CpuCmd::TRIANGLE:
+                    cpu_raster::triangle_rows(c, dst, stride, x0, y0, x1, y1);
+                    break;
+            }
+        }
+    }
+
+private:
+    bool clip(CpuCmd& cmd, float x0, float y0, float x1, float y1) const {
+        cmd.x0 = std::max(originX, (int)x0);
+        cmd.y0 = std::max(originY, (int)y0);
+        cmd.x1 = std::min(originX + width,  (int)x1);
+        cmd.y1 = std::min(originY + height, (int)y1);
+        return cmd.x0 < cmd.x1 && cmd.y0 < cmd.y1;
+    }
+};
+
+// Owns the images, the frame buffer and the streaming texture it is shown through
+struct CpuRenderer {
+    static constexpr int TILE = 64;
+
+    CpuImageMap images;
+    CpuDrawList list;
+    std::vector<uint32_t> frame;
+    ThreadPool* pool = nullptr;
+    SDL_Texture* target = nullptr;
+    int targetW = 0, targetH = 0;
+    bool avx2 = false;
+
+    void init(ThreadPool* workers){
+        pool = workers;
+#ifdef TF_CPU_RASTER_AVX2
+        avx2 = SDL_HasAVX2() == SDL_TRUE;
+#endif
+    }
+
+    void add_image(SDL_Texture* tex, SDL_Surface* surf){
+        if(!tex || !surf) return;
+        if(!cpu_image_from_surface(images[tex], surf)) images.erase(tex);
+    }
+
+    void remove_image(SDL_Texture* tex){ images.erase(tex); }
+
+    void begin(int w, int h){
+        list.reset(w, h);
+        frame.resize((size_t)w * h);
+    }
+
+    void rasterize(){
+        const int w = list.width, h = list.height;
+        const int tilesX = (w + TILE - 1) / TILE, tilesY = (h + TILE - 1) / TILE;
+        auto tile = [&](int t){
+            int tx = (t % tilesX) * TILE, ty = (t / tilesX) * TILE;
+            SDL_Rect region = { tx, ty, std::min(TILE, w - tx), std::min(TILE, h - ty) };
+            list.raster(frame.data(), w, region, avx2);
+        };
+        if(pool) pool->parallel_for(tilesX * tilesY, tile);
+        else for(int t = 0; t < tilesX * tilesY; ++t) tile(t);
+    }
+
+    // Upload the frame and draw it over the whole render target
+    bool present(SDL_Renderer* renderer){
+        if(!target || targetW != list.width || targetH != list.height){
+            if(target) SDL_DestroyTexture(target);
+            target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, list.width, list.height);
+            targetW = list.width; targetH = list.height;
+            if(!target) return false;
+        }
+        SDL_UpdateTexture(target, nullptr, frame.data(), list.width * 4);
+        SDL_RenderCopy(renderer, target, nullptr, nullptr);
+        return true;
+    }
+
+    void destroy(){
+        if(target) SDL_DestroyTexture(target);
+        target = nullptr;
+        images.clear();
+    }
+};
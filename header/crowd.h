@@ -0,0 +1,247 @@
+// Local avoidance for crowds of players: ORCA (optimal reciprocal collision
+// avoidance, van den Berg et al.). Each reactive agent turns every nearby
+// agent into a half-plane of velocities that stay collision-free for
+// timeHorizon seconds, then picks the velocity closest to the one it wants
+// inside all of them (2D linear program; if they cannot all hold, the one
+// that violates them least). Two reactive agents each take half of the
+// avoidance; agents that do not react (human players) are avoided fully.
+//
+// Neighbors come from a uniform grid rebuilt per solve by counting sort,
+// with cells at least neighborDist wide, so a query reads a 3x3 block and
+// keeps the MAX_NEIGHBORS closest. Everything is O(agents); the buffers are
+// reused, so steady-state solves do not allocate.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+struct CrowdAgent {
+    float x, y;            // centre, px
+    float vx, vy;          // velocity this tick, px/s
+    float prefVx, prefVy;  // velocity it wants
+    float radius;
+    float maxSpeed;
+    bool reactive;         // false: keeps (vx, vy), others avoid it
+};
+
+struct CrowdAvoidance {
+    static constexpr int MAX_NEIGHBORS = 10;
+    float neighborDist = 96.0f;  // px, only agents this close are considered
+    float timeHorizon = 0.5f;    // s
+
+    std::vector<CrowdAgent> agents;
+    std::vector<float> outVx, outVy; // result per agent, px/s
+
+    void clear(){ agents.clear(); }
+    void add(const CrowdAgent& a){ agents.push_back(a); }
+
+    void solve(float dt){
+        const int n = (int)agents.size();
+        outVx.resize(n);
+        outVy.resize(n);
+        if(n == 0) return;
+        build_grid();
+        const float invDt = 1.0f / std::max(dt, 1e-4f);
+        for(int i = 0; i < n; ++i){
+            const CrowdAgent& a = agents[i];
+            if(!a.reactive){ outVx[i] = a.vx; outVy[i] = a.vy; continue; }
+            Neighbor nb[MAX_NEIGHBORS];
+            int count = neighbors(i, nb);
+            Line lines[MAX_NEIGHBORS];
+            for(int k = 0; k < count; ++k) lines[k] = orca_line(a, agents[nb[k].index], invDt);
+            Vec2 v = { a.vx, a.vy };
+            Vec2 pref = { a.prefVx, a.prefVy };
+            int failed = solve_lp2(lines, count, a.maxSpeed, pref, false, v);
+            if(failed < count) solve_lp3(lines, count, failed, a.maxSpeed, v);
+            outVx[i] = v.x;
+            outVy[i] = v.y;
+        }
+    }
+
+private:
+    struct Vec2 { float x, y; };
+    struct Line { Vec2 point, dir; }; // allowed side: left of dir
+    struct Neighbor { float distSq; int index; };
+
+    static float dot(Vec2 a, Vec2 b){ return a.x*b.x + a.y*b.y; }
+    static float det(Vec2 a, Vec2 b){ return a.x*b.y - a.y*b.x; }
+    static Vec2 sub(Vec2 a, Vec2 b){ return { a.x - b.x, a.y - b.y }; }
+    static Vec2 add(Vec2 a, Vec2 b){ return { a.x + b.x, a.y + b.y }; }
+    static Vec2 mul(Vec2 a, float s){ return { a.x*s, a.y*s }; }
+    static constexpr float EPS = 1e-5f;
+
+    // Grid: agents sorted by cell, cellStart[c]..cellStart[c+1] in `sorted`
+    float gridX = 0, gridY = 0, cell = 1;
+    int gw = 1, gh = 1;
+    std::vector<int> cellOf, cellStart, sorted;
+
+    void build_grid(){
+        const int n = (int)agents.size();
+        float minX = agents[0].x, maxX = minX, minY = agents[0].y, maxY = minY;
+        for(const CrowdAgent& a : agents){
+            minX = std::min(minX, a.x); maxX = std::max(maxX, a.x);
+            minY = std::min(minY, a.y); maxY = std::max(maxY, a.y);
+        }
+        // Cells no narrower than the query radius, and no more of them than ~4 per agent
+        cell = std::max(neighborDist, 1.0f);
+        for(;;){
+            gw = (int)((maxX - minX) / cell) + 1;
+            gh = (int)((maxY - minY) / cell) + 1;
+            if((int64_t)gw * gh <= 4 * (int64_t)n + 64) break;
+            cell *= 2.0f;
+        }
+        gridX = minX; gridY = minY;
+        cellOf.resize(n);
+        cellStart.assign((size_t)gw * gh + 1, 0);
+        sorted.resize(n);
+        for(int i = 0; i < n; ++i){
+            int c = cell_x(agents[i].x) + cell_y(agents[i].y) * gw;
+            cellOf[i] = c;
+            ++cellStart[c + 1];
+        }
+        for(size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+        for(int i = 0; i < n; ++i) sorted[cellStart[cellOf[i]]++] = i;
+        // cellStart[c] now holds the end of cell c: shift back by one cell
+        for(size_t c = cellStart.size() - 1; c > 0; --c) cellStart[c] = cellStart[c - 1];
+        cellStart[0] = 0;
+    }
+    int cell_x(float x) const { return std::clamp((int)((x - gridX) / cell), 0, gw - 1); }
+    int cell_y(float y) const { return std::clamp((int)((y - gridY) / cell), 0, gh - 1); }
+
+    // The MAX_NEIGHBORS closest agents within neighborDist, nearest first
+    int neighbors(int self, Neighbor* out) const {
+        const CrowdAgent& a = agents[self];
+        const float rangeSq = neighborDist * neighborDist;
+        int count = 0;
+        const int x0 = cell_x(a.x - neighborDist), x1 = cell_x(a.x + neighborDist);
+        const int y0 = cell_y(a.y - neighborDist), y1 = cell_y(a.y + neighborDist);
+        for(int cy = y0; cy <= y1; ++cy){
+            for(int cx = x0; cx <= x1; ++cx){
+                const int c = cx + cy * gw;
+                for(int s = cellStart[c]; s < cellStart[c + 1]; ++s){
+                    const int j = sorted[s];
+                    if(j == self) continue;
+                    float dx = agents[j].x - a.x, dy = agents[j].y - a.y;
+                    float d = dx*dx + dy*dy;
+                    if(d >= rangeSq || (count == MAX_NEIGHBORS && d >= out[count - 1].distSq)) continue;
+                    int k = count < MAX_NEIGHBORS ? count++ : count - 1;
+                    while(k > 0 && out[k - 1].distSq > d){ out[k] = out[k - 1]; --k; }
+                    out[k] = { d, j };
+                }
+            }
+        }
+        return count;
+    }
+
+    // Half-plane of velocities for a that avoid b for timeHorizon (or
+    // resolve an existing overlap within one tick)
+    Line orca_line(const CrowdAgent& a, const CrowdAgent& b, float invDt) const {
+        Vec2 relPos = { b.x - a.x, b.y - a.y };
+        if(dot(relPos, relPos) < 1e-6f) relPos = { &b > &a ? 0.01f : -0.01f, 0.0f }; // same spot: split along x
+        const Vec2 relVel = { a.vx - b.vx, a.vy - b.vy };
+        const float distSq = dot(relPos, relPos);
+        const float r = a.radius + b.radius;
+        const float rSq = r * r;
+        const float invTau = 1.0f / timeHorizon;
+        Line line;
+        Vec2 u;
+        if(distSq > rSq){
+            const Vec2 w = sub(relVel, mul(relPos, invTau)); // from cut-off circle centre to relVel
+            const float wLenSq = dot(w, w);
+            const float dotWP = dot(w, relPos);
+            if(dotWP < 0.0f && dotWP * dotWP > rSq * wLenSq){
+                // project on the cut-off circle
+                const float wLen = std::sqrt(wLenSq);
+                const Vec2 unitW = mul(w, 1.0f / wLen);
+                line.dir = { unitW.y, -unitW.x };
+                u = mul(unitW, r * invTau - wLen);
+            } else {
+                // project on a leg of the cone
+                const float leg = std::sqrt(distSq - rSq);
+                if(det(relPos, w) > 0.0f) line.dir = mul(Vec2{ relPos.x*leg - relPos.y*r, relPos.x*r + relPos.y*leg }, 1.0f / distSq);
+                else line.dir = mul(Vec2{ relPos.x*leg + relPos.y*r, -relPos.x*r + relPos.y*leg }, -1.0f / distSq);
+                u = sub(mul(line.dir, dot(relVel, line.dir)), relVel);
+            }
+        } else {
+            // already overlapping: separate within this tick
+            const Vec2 w = sub(relVel, mul(relPos, invDt));
+            const float wLen = std::max(std::sqrt(dot(w, w)), EPS);
+            const Vec2 unitW = mul(w, 1.0f / wLen);
+            line.dir = { unitW.y, -unitW.x };
+            u = mul(unitW, r * invDt - wLen);
+        }
+        const float share = b.reactive ? 0.5f : 1.0f;
+        line.point = add(Vec2{ a.vx, a.vy }, mul(u, share));
+        return line;
+    }
+
+    // Best point on line i that satisfies lines [0, i) and the speed circle
+    static bool solve_lp1(const Line* lines, int i, float radius, Vec2 opt, bool dirOpt, Vec2& result){
+        const float d = dot(lines[i].point, lines[i].dir);
+        const float disc = d*d + radius*radius - dot(lines[i].point, lines[i].point);
+        if(disc < 0.0f) return false;
+        const float sq = std::sqrt(disc);
+        float tLeft = -d - sq, tRight = -d + sq;
+        for(int j = 0; j < i; ++j){
+            const float denom = det(lines[i].dir, lines[j].dir);
+            const float numer = det(lines[j].dir, sub(lines[i].point, lines[j].point));
+            if(std::fabs(denom) <= EPS){
+                if(numer < 0.0f) return false; // parallel and on the wrong side
+                continue;
+            }
+            const float t = numer / denom;
+            if(denom >= 0.0f) tRight = std::min(tRight, t);
+            else tLeft = std::max(tLeft, t);
+            if(tLeft > tRight) return false;
+        }
+        float t;
+        if(dirOpt) t = dot(opt, lines[i].dir) > 0.0f ? tRight : tLeft;
+        else t = std::clamp(dot(lines[i].dir, sub(opt, lines[i].point)), tLeft, tRight);
+        result = add(lines[i].point, mul(lines[i].dir, t));
+        return true;
+    }
+
+    // Velocity closest to opt (or furthest along opt if dirOpt) inside all
+    // lines and the speed circle; returns the first line it could not satisfy
+    static int solve_lp2(const Line* lines, int count, float radius, Vec2 opt, bool dirOpt, Vec2& result){
+        if(dirOpt) result = mul(opt, radius);
+        else if(dot(opt, opt) > radius*radius) result = mul(opt, radius / std::sqrt(dot(opt, opt)));
+        else result = opt;
+        for(int i = 0; i < count; ++i){
+            if(det(lines[i].dir, sub(lines[i].point, result)) > 0.0f){
+                const Vec2 keep = result;
+                if(!solve_lp1(lines, i, radius, opt, dirOpt, result)){ result = keep; return i; }
+            }
+        }
+        return count;
+    }
+
+    // Infeasible: minimize the largest violation, starting at line `begin`
+    static void solve_lp3(const Line* lines, int count, int begin, float radius, Vec2& result){
+        float distance = 0.0f;
+        Line proj[MAX_NEIGHBORS];
+        for(int i = begin; i < count; ++i){
+            if(det(lines[i].dir, sub(lines[i].point, result)) <= distance) continue;
+            int pc = 0;
+            for(int j = 0; j < i; ++j){
+                Line l;
+                const float d = det(lines[i].dir, lines[j].dir);
+                if(std::fabs(d) <= EPS){
+                    if(dot(lines[i].dir, lines[j].dir) > 0.0f) continue; // same direction
+                    l.point = mul(add(lines[i].point, lines[j].point), 0.5f);
+                } else {
+                    l.point = add(lines[i].point, mul(lines[i].dir, det(lines[j].dir, sub(lines[i].point, lines[j].point)) / d));
+                }
+                Vec2 dir = sub(lines[j].dir, lines[i].dir);
+                const float len = std::sqrt(dot(dir, dir));
+                l.dir = len > EPS ? mul(dir, 1.0f / len) : dir;
+                proj[pc++] = l;
+            }
+            const Vec2 keep = result;
+            if(solve_lp2(proj, pc, radius, Vec2{ -lines[i].dir.y, lines[i].dir.x }, true, result) < pc) result = keep;
+            distance = det(lines[i].dir, sub(lines[i].point, result));
+        }
+    }
+};
@@ -0,0 +1,102 @@
+// Debug geometry overlay: lines, rects, circles and arrows accumulated into
+// one vertex buffer during the frame and drawn with a single
+// geometry call in flush(). Each primitive belongs to a category
+// that can be toggled; a disabled category costs one bit test per call.
+#pragma once
+
+#include <SDL.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "canvas.h"
+
+enum DebugCategory : uint32_t {
+    DBG_HITBOX   = 1u << 0,  // player rects, ball rect, goal lines
+    DBG_KICK     = 1u << 1,  // kick radius (the circle canKickBall tests)
+    DBG_VELOCITY = 1u << 2,  // ball / player velocity arrows
+    DBG_AI       = 1u << 3,  // AI targets
+    DBG_ASSIST   = 1u << 4,  // pass lanes / shot window of the controlled ball carrier
+};
+
+struct DebugDraw {
+    static constexpr int MAX_VERTS = 6 * 4096; // 4096 line segments per frame
+
+    uint32_t enabled = 0;
+    std::vector<SDL_Vertex> verts;
+    int count = 0;
+    int overflow = 0; // segments dropped this frame
+
+    DebugDraw(){ verts.resize(MAX_VERTS); }
+
+    bool on(uint32_t cat) const { return (enabled & cat) != 0; }
+    void toggle(uint32_t cat){ enabled ^= cat; }
+
+    void line(uint32_t cat, float x0, float y0, float x1, float y1, SDL_Color c, float thickness = 1.5f){
+        if(!on(cat)) return;
+        segment(x0, y0, x1, y1, c, thickness);
+    }
+
+    void rect(uint32_t cat, float x, float y, float w, float h, SDL_Color c){
+        if(!on(cat)) return;
+        segment(x,     y,     x + w, y,     c, 1.0f);
+        segment(x + w, y,     x + w, y + h, c, 1.0f);
+        segment(x + w, y + h, x,     y + h, c, 1.0f);
+        segment(x,     y + h, x,     y,     c, 1.0f);
+    }
+
+    void circle(uint32_t cat, float cx, float cy, float r, SDL_Color c, int segments = 32){
+        if(!on(cat)) return;
+        const float step = 6.2831853f / segments;
+        float px = cx + r, py = cy;
+        for(int i = 1; i <= segments; ++i){
+            float nx = cx + r * cosf(step * i);
+            float ny = cy + r * sinf(step * i);
+            segment(px, py, nx, ny, c, 1.5f);
+            px = nx; py = ny;
+        }
+    }
+
+    void arrow(uint32_t cat, float x0, float y0, float x1, float y1, SDL_Color c){
+        if(!on(cat)) return;
+        float dx = x1 - x0, dy = y1 - y0;
+        float len = std::sqrt(dx*dx + dy*dy);
+        if(len < 0.5f) return;
+        dx /= len; dy /= len;
+        float head = len < 24.0f ? len * 0.4f : 10.0f;
+        segment(x0, y0, x1, y1, c, 2.0f);
+        segment(x1, y1, x1 - head * (dx * 0.87f - dy * 0.5f), y1 - head * (dy * 0.87f + dx * 0.5f), c, 2.0f);
+        segment(x1, y1, x1 - head * (dx * 0.87f + dy * 0.5f), y1 - head * (dy * 0.87f - dx * 0.5f), c, 2.0f);
+    }
+
+    void cross(uint32_t cat, float x, float y, float size, SDL_Color c){
+        if(!on(cat)) return;
+        segment(x - size, y - size, x + size, y + size, c, 1.5f);
+        segment(x - size, y + size, x + size, y - size, c, 1.5f);
+    }
+
+    // Draw everything accumulated this frame in one call, then reset
+    void flush(Canvas& canvas){
+        if(count > 0) canvas.geometry(verts.data(), count, nullptr, 0);
+        count = 0;
+        overflow = 0;
+    }
+
+private:
+    // Thick segment = 2 triangles
+    void segment(float x0, float y0, float x1, float y1, SDL_Color c, float thickness){
+        if(count + 6 > MAX_VERTS){ ++overflow; return; }
+        float dx = x1 - x0, dy = y1 - y0;
+        float len = std::sqrt(dx*dx + dy*dy);
+        float nx = 0.0f, ny = 0.0f;
+        if(len > 0.0001f){ nx = -dy / len * thickness * 0.5f; ny = dx / len * thickness * 0.5f; }
+        SDL_Vertex* v = &verts[count];
+        v[0] = { { x0 + nx, y0 + ny }, c, { 0, 0 } };
+        v[1] = { { x1 + nx, y1 + ny }, c, { 0, 0 } };
+        v[2] = { { x1 - nx, y1 - ny }, c, { 0, 0 } };
+        v[3] = v[0];
+        v[4] = v[2];
+        v[5] = { { x0 - nx, y0 - ny }, c, { 0, 0 } };
+        count += 6;
+    }
+};
@@ -0,0 +1,63 @@
+// Dirty-rectangle accumulation for partial redraws (software renderer path).
+// Rects are clipped to the screen and merged when they overlap or when
+// merging wastes little area; past a budget it degrades to one full-screen
+// rect, which is never slower than a normal redraw.
+#pragma once
+
+#include <SDL.h>
+
+struct DirtyRects {
+    static constexpr int MAX = 32;
+
+    SDL_Rect rects[MAX];
+    int count = 0;
+    bool full = false;
+
+    void clear(){ count = 0; full = false; }
+    void add_full(){ full = true; }
+
+    void add(const SDL_Rect& r){
+        if(r.w <= 0 || r.h <= 0) return;
+        if(count == MAX){ full = true; return; }
+        rects[count++] = r;
+    }
+
+    // Clip to the screen, merge, and fall back to a full redraw when the
+    // rects cover most of it anyway
+    void finalize(int screenW, int screenH){
+        const SDL_Rect screen = { 0, 0, screenW, screenH };
+        if(full){ rects[0] = screen; count = 1; return; }
+
+        int n = 0;
+        for(int i = 0; i < count; ++i){
+            SDL_Rect c;
+            if(SDL_IntersectRect(&rects[i], &screen, &c)) rects[n++] = c;
+        }
+        count = n;
+
+        bool merged = true;
+        while(merged){
+            merged = false;
+            for(int i = 0; i < count && !merged; ++i){
+                for(int j = i + 1; j < count; ++j){
+                    SDL_Rect u;
+                    SDL_UnionRect(&rects[i], &rects[j], &u);
+                    long areaU = (long)u.w * u.h;
+                    long areaI = (long)rects[i].w * rects[i].h;
+                    long areaJ = (long)rects[j].w * rects[j].h;
+                    // overlapping, or the union wastes less than 25% extra pixels
+                    if(SDL_HasIntersection(&rects[i], &rects[j]) || areaU * 4 <= (areaI + areaJ) * 5){
+                        rects[i] = u;
+                        rects[j] = rects[--count];
+                        merged = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        long total = 0;
+        for(int i = 0; i < count; ++i) total += (long)rects[i].w * rects[i].h;
+        if(total * 10 > (long)screenW * screenH * 6){ rects[0] = screen; count = 1; }
+    }
+};
@@ -0,0 +1,22 @@
+// FNV-1a 64-bit hashing for change detection and cache keys
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct Fnv1a {
+    uint64_t h = 14695981039346656037ULL;
+
+    void add(const void* data, size_t len){
+        const unsigned char* p = (const unsigned char*)data;
+        for(size_t i = 0; i < len; ++i){
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+    }
+
+    template<class T>
+    void add(const T& v){ add(&v, sizeof(T)); }
+
+    uint64_t value() const { return h; }
+};
@@ -0,0 +1,147 @@
+// Team kits from the Kenney character sets (PNG/<Folder>/character<Folder> (n).png).
+// Textures are loaded the first time a kit is used and the least recently
+// used kits are evicted when the estimated texture memory goes over budget.
+// Kits used in the current frame are never evicted: the budget can be
+// exceeded for a frame rather than thrash or free a texture still on screen.
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+
+#include "log.h"
+
+struct KitDef {
+    const char* name;    // --kits / HUD name
+    const char* folder;  // PNG/<folder>/character<folder> (n).png
+    int body, arm, leg;  // sprite numbers
+};
+
+// Special only has 12 sprites: no sleeve variants, leg is (12)
+inline constexpr KitDef KITS[] = {
+    { "blue",    "Blue",    1, 11, 13 },
+    { "red",     "Red",     1, 11, 13 },
+    { "white",   "White",   1, 11, 13 },
+    { "green",   "Green",   1, 11, 13 },
+    { "special", "Special", 1, 11, 12 },
+};
+constexpr int KIT_COUNT = (int)(sizeof(KITS) / sizeof(KITS[0]));
+
+inline int kit_by_name(const char* name){
+    for(int i = 0; i < KIT_COUNT; ++i){
+        if(SDL_strcasecmp(name, KITS[i].name) == 0) return i;
+    }
+    return -1;
+}
+
+struct KitTextures {
+    SDL_Texture* body = nullptr;
+    SDL_Texture* arm  = nullptr;
+    SDL_Texture* leg  = nullptr;
+};
+
+struct KitCache {
+    struct Entry {
+        KitTextures tex;
+        size_t bytes = 0;
+        uint64_t lastUse = 0;
+        bool loaded = false;
+    };
+
+    // A kit is ~4.6 KB (21x31 body, 19x13 arm and leg): room for the two on
+    // the pitch plus the one last swapped out, so F7/F8 cycling evicts
+    static constexpr size_t DEFAULT_BUDGET = 16 * 1024;
+
+    Entry entries[KIT_COUNT];
+    size_t budget = DEFAULT_BUDGET; // estimated bytes of kit textures (w * h * 4)
+    size_t used = 0;
+    uint64_t frame = 0;
+    int loads = 0, evictions = 0;
+    const char* root = "../kenney_sports-pack/PNG";
+
+    // Provided by the owner: create / destroy one texture
+    std::function<SDL_Texture*(const char*)> load;
+    std::function<void(SDL_Texture*)> release;
+    // Optional: bytes one texture takes (default w * h * 4 from SDL_QueryTexture)
+    std::function<size_t(SDL_Texture*)> measure;
+
+    void begin_frame(){ ++frame; }
+
+    // Mark a kit as used this frame without loading it. Call for every kit
+    // on screen before acquiring any, so loading one cannot evict another.
+    void touch(int kit){
+        if(kit >= 0 && kit < KIT_COUNT) entries[kit].lastUse = frame;
+    }
+
+    const KitTextures& acquire(int kit){
+        static const KitTextures none;
+        if(kit < 0 || kit >= KIT_COUNT) return none;
+        Entry& e = entries[kit];
+        e.lastUse = frame;
+        if(!e.loaded){
+            const KitDef& d = KITS[kit];
+            e.tex.body = load_sprite(d, d.body);
+            e.tex.arm  = load_sprite(d, d.arm);
+            e.tex.leg  = load_sprite(d, d.leg);
+            if(!e.tex.body || !e.tex.leg) LOG_WARN("Kit '%s' incomplete, drawing placeholder", d.name);
+            e.bytes = texture_bytes(e.tex.body) + texture_bytes(e.tex.arm) + texture_bytes(e.tex.leg);
+            e.loaded = true; // không thử nạp lại mỗi frame nếu thiếu file
+            used += e.bytes;
+            ++loads;
+            LOG_DEBUG("Kit '%s' loaded (%zu KB)", d.name, e.bytes / 1024);
+            evict_to_budget();
+        }
+        return e.tex;
+    }
+
+    void evict_to_budget(){
+        while(used > budget){
+            int victim = -1;
+            for(int i = 0; i < KIT_COUNT; ++i){
+                const Entry& e = entries[i];
+                if(!e.loaded || e.lastUse == frame) continue;
+                if(victim < 0 || e.lastUse < entries[victim].lastUse) victim = i;
+            }
+            if(victim < 0) break; // everything left is on screen
+            LOG_DEBUG("Kit '%s' evicted", KITS[victim].name);
+            unload(victim);
+            ++evictions;
+        }
+    }
+
+    int loaded_count() const {
+        int n = 0;
+        for(const Entry& e : entries) n += e.loaded ? 1 : 0;
+        return n;
+    }
+
+    void clear(){
+        for(int i = 0; i < KIT_COUNT; ++i) unload(i);
+    }
+
+private:
+    SDL_Texture* load_sprite(const KitDef& d, int n){
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s/character%s (%d).png", root, d.folder, d.folder, n);
+        return load ? load(path) : nullptr;
+    }
+
+    size_t texture_bytes(SDL_Texture* t) const {
+        if(t && measure) return measure(t);
+        int w = 0, h = 0;
+        if(!t || SDL_QueryTexture(t, nullptr, nullptr, &w, &h) != 0) return 0;
+        return (size_t)w * h * 4;
+    }
+
+    void unload(int i){
+        Entry& e = entries[i];
+        if(!e.loaded) return;
+        for(SDL_Texture* t : { e.tex.body, e.tex.arm, e.tex.leg }){
+            if(t && release) release(t);
+        }
+        used -= e.bytes;
+        e = Entry{};
+    }
+};
@@ -0,0 +1,304 @@
+// Asynchronous logging: LOG_INFO("fmt", args...) never formats, locks or
+// writes on the calling thread. It copies the format pointer and the
+// arguments into a fixed-size binary record on that thread's own
+// single-producer / single-consumer ring; a background thread formats the
+// records printf-style, merges the rings by timestamp and writes them out.
+// A full ring drops the record (counted, reported later) instead of waiting.
+// Every call site is rate limited; suppressed repeats are reported with the
+// next message that gets through.
+//
+// The format must be a string literal (only its pointer is stored). Strings
+// are copied, up to Record::TEXT bytes per record.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum LogLevel : uint8_t { LOG_LEVEL_DEBUG, LOG_LEVEL_INFO, LOG_LEVEL_WARN, LOG_LEVEL_ERROR, LOG_LEVEL_OFF };
+
+namespace logging {
+
+struct Arg {
+    char type; // 'i' signed, 'u' unsigned, 'f' floating, 'p' pointer, 's' string (offset/len into Record::text)
+    union {
+        long long i;
+        unsigned long long u;
+        double f;
+        const void* p;
+        struct { uint16_t offset, len; } s;
+    };
+};
+
+struct Record {
+    static constexpr int MAX_ARGS = 8;
+    static constexpr int TEXT = 128;
+
+    double time;
+    const char* fmt;
+    uint32_t suppressed;
+    uint8_t level, nargs;
+    uint16_t textUsed;
+    Arg args[MAX_ARGS];
+    char text[TEXT];
+
+    void push_string(const char* str, size_t len){
+        Arg& a = args[nargs++];
+        a.type = 's';
+        len = std::min(len, (size_t)(TEXT - textUsed));
+        memcpy(text + textUsed, str, len);
+        a.s = { textUsed, (uint16_t)len };
+        textUsed = (uint16_t)(textUsed + len);
+    }
+
+    template<class T>
+    void push(const T& v){
+        using U = std::decay_t<T>;
+        if constexpr(std::is_same_v<U, std::string>) push_string(v.data(), v.size());
+        else if constexpr(std::is_same_v<U, char*> || std::is_same_v<U, const char*>) {
+            const char* str = v;
+            if(str) push_string(str, strlen(str));
+            else push_string("(null)", 6);
+        }
+        else {
+            Arg& a = args[nargs++];
+            if constexpr(std::is_floating_point_v<U>) { a.type = 'f'; a.f = (double)v; }
+            else if constexpr(std::is_pointer_v<U>) { a.type = 'p'; a.p = (const void*)v; }
+            else if constexpr(std::is_enum_v<U> || std::is_signed_v<U>) { a.type = 'i'; a.i = (long long)v; }
+            else { static_assert(std::is_integral_v<U>, "unsupported log argument"); a.type = 'u'; a.u = (unsigned long long)v; }
+        }
+    }
+};
+
+struct Ring {
+    static constexpr uint32_t SIZE = 256; // records, power of two
+
+    Record slots[SIZE];
+    alignas(64) std::atomic<uint32_t> head{ 0 };    // next slot the producer writes
+    alignas(64) std::atomic<uint32_t> tail{ 0 };    // next slot the consumer reads
+    std::atomic<uint32_t> dropped{ 0 };
+};
+
+// Per call site: at most `perSecond` records, the rest only counted
+struct LogSite {
+    uint32_t perSecond = 20;
+    std::atomic<uint32_t> window{ 0xFFFFFFFFu };
+    std::atomic<uint32_t> count{ 0 };
+    std::atomic<uint32_t> suppressed{ 0 };
+
+    bool allow(double now){
+        uint32_t sec = (uint32_t)now;
+        if(window.load(std::memory_order_relaxed) != sec){
+            window.store(sec, std::memory_order_relaxed);
+            count.store(0, std::memory_order_relaxed);
+        }
+        if(count.fetch_add(1, std::memory_order_relaxed) < perSecond) return true;
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+};
+
+// printf one conversion spec with the stored argument, converting to what the spec expects
+inline int format_arg(char* out, size_t cap, const char* spec, size_t specLen, const Record& r, const Arg& a){
+    char conv = spec[specLen - 1];
+    char fmt[32];
+    size_t n = 0;
+    for(size_t k = 0; k + 1 < specLen && n < sizeof(fmt) - 4; ++k){
+        char ch = spec[k];
+        if(ch != 'l' && ch != 'h' && ch != 'z' && ch != 'j' && ch != 't' && ch != 'L') fmt[n++] = ch; // drop length modifiers
+    }
+    auto as_ll  = [&]{ return a.type == 'f' ? (long long)a.f : a.type == 'u' ? (long long)a.u : a.i; };
+    auto as_ull = [&]{ return a.type == 'f' ? (unsigned long long)a.f : a.type == 'i' ? (unsigned long long)a.i : a.u; };
+    switch(conv){
+        case 'd': case 'i':
+            fmt[n++] = 'l'; fmt[n++] = 'l'; fmt[n++] = conv; fmt[n] = 0;
+            return snprintf(out, cap, fmt, as_ll());
+        case 'u': case 'x': case 'X': case 'o':
+            fmt[n++] = 'l'; fmt[n++] = 'l'; fmt[n++] = conv; fmt[n] = 0;
+            return snprintf(out, cap, fmt, as_ull());
+        case 'c':
+            fmt[n++] = 'c'; fmt[n] = 0;
+            return snprintf(out, cap, fmt, (int)as_ll());
+        case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+            fmt[n++] = conv; fmt[n] = 0;
+            return snprintf(out, cap, fmt, a.type == 'f' ? a.f : a.type == 'u' ? (double)a.u : (double)a.i);
+        case 'p':
+            fmt[n++] = 'p'; fmt[n] = 0;
+            return snprintf(out, cap, fmt, a.p);
+        case 's': {
+            if(a.type != 's') return snprintf(out, cap, "(?)");
+            // flags/width from the spec, precision folded into the stored length
+            int len = a.s.len;
+            size_t m = 0;
+            for(size_t k = 0; k + 1 < specLen && spec[k] != '.' && m < sizeof(fmt) - 4; ++k) fmt[m++] = spec[k];
+            if(const char* dot = (const char*)memchr(spec, '.', specLen)) len = std::min(len, atoi(dot + 1));
+            memcpy(fmt + m, ".*s", 4);
+            return snprintf(out, cap, fmt, len, r.text + a.s.offset);
+        }
+    }
+    return snprintf(out, cap, "%.*s", (int)specLen, spec);
+}
+
+// Record -> text (no trailing newline)
+inline size_t format_record(const Record& r, char* out, size_t cap){
+    size_t n = 0;
+    int argi = 0;
+    auto room = [&]{ return n < cap ? cap - n : 0; };
+    for(const char* p = r.fmt; *p && n + 1 < cap; ++p){
+        if(*p != '%'){ out[n++] = *p; continue; }
+        if(p[1] == '%'){ out[n++] = '%'; ++p; continue; }
+        const char* spec = p;
+        size_t len = 1;
+        while(spec[len] && !strchr("diouxXeEfFgGaAcsp", spec[len])) ++len;
+        if(!spec[len]) break;
+        ++len;
+        p += len - 1;
+        int w = argi < r.nargs ? format_arg(out + n, room(), spec, len, r, r.args[argi++])
+                               : snprintf(out + n, room(), "%.*s", (int)len, spec);
+        if(w > 0) n = std::min(cap - 1, n + (size_t)w);
+    }
+    while(n > 0 && out[n - 1] == '\n') --n;
+    out[std::min(n, cap - 1)] = 0;
+    return n;
+}
+
+struct Logger {
+    std::atomic<int> minLevel{ LOG_LEVEL_INFO };
+    FILE* out = stdout;
+
+    static Logger& get(){
+        static Logger logger;
+        return logger;
+    }
+
+    double now() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    Ring& ring(){
+        thread_local Ring* r = nullptr;
+        if(!r){
+            std::lock_guard<std::mutex> lock(ringsMtx); // once per thread
+            rings.push_back(std::make_unique<Ring>());
+            r = rings.back().get();
+        }
+        return *r;
+    }
+
+    // Write everything queued so far (any thread; waits for the background thread)
+    void flush(){
+        std::lock_guard<std::mutex> lock(drainMtx);
+        drain();
+    }
+
+    ~Logger(){
+        quit = true;
+        if(worker.joinable()) worker.join();
+        flush();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::mutex ringsMtx, drainMtx;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Record> batch;
+    std::atomic<bool> quit{ false };
+    std::thread worker;
+
+    Logger(){ worker = std::thread([this]{ run(); }); }
+
+    void run(){
+        while(!quit){
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::lock_guard<std::mutex> lock(drainMtx);
+            drain();
+        }
+    }
+
+    void drain(){
+        uint32_t dropped = 0;
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(ringsMtx);
+            for(auto& r : rings){
+                uint32_t tail = r->tail.load(std::memory_order_relaxed);
+                uint32_t head = r->head.load(std::memory_order_acquire);
+                for(; tail != head; ++tail) batch.push_back(r->slots[tail & (Ring::SIZE - 1)]);
+                r->tail.store(tail, std::memory_order_release);
+                dropped += r->dropped.exchange(0, std::memory_order_relaxed);
+            }
+        }
+        if(batch.empty() && !dropped) return;
+        std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b){ return a.time < b.time; });
+
+        static const char* const TAGS[] = { "DEBUG", "INFO ", "WARN ", "ERROR" };
+        char line[512];
+        for(const Record& r : batch){
+            format_record(r, line, sizeof(line));
+            fprintf(out, "[%8.3f] %s %s", r.time, TAGS[std::min<int>(r.level, LOG_LEVEL_ERROR)], line);
+            if(r.suppressed) fprintf(out, " (+%u suppressed)", r.suppressed);
+            fputc('\n', out);
+        }
+        if(dropped) fprintf(out, "[%8.3f] WARN  log queue full, dropped %u records\n", now(), dropped);
+        fflush(out);
+    }
+};
+
+template<class... Args>
+inline void write(LogSite& site, LogLevel level, const char* fmt, const Args&... args){
+    static_assert(sizeof...(Args) <= Record::MAX_ARGS, "too many log arguments");
+    Logger& lg = Logger::get();
+    double t = lg.now();
+    if(!site.allow(t)) return;
+    Ring& r = lg.ring();
+    uint32_t head = r.head.load(std::memory_order_relaxed);
+    if(head - r.tail.load(std::memory_order_acquire) >= Ring::SIZE){
+        r.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Record& rec = r.slots[head & (Ring::SIZE - 1)];
+    rec.time = t;
+    rec.fmt = fmt;
+    rec.level = level;
+    rec.nargs = 0;
+    rec.textUsed = 0;
+    rec.suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+    (rec.push(args), ...);
+    r.head.store(head + 1, std::memory_order_release);
+}
+
+inline void set_level(LogLevel level){ Logger::get().minLevel = level; }
+inline int min_level(){ return Logger::get().minLevel.load(std::memory_order_relaxed); }
+inline void flush(){ Logger::get().flush(); }
+
+inline bool parse_level(const char* name, LogLevel& out){
+    static const char* const NAMES[] = { "debug", "info", "warn", "error", "off" };
+    for(int i = 0; i <= LOG_LEVEL_OFF; ++i){
+        if(strcmp(name, NAMES[i]) == 0){ out = (LogLevel)i; return true; }
+    }
+    return false;
+}
+
+} // namespace logging
+
+#define TF_LOG(level, ...) do { \
+        if((level) >= logging::min_level()){ \
+            static logging::LogSite tf_log_site_; \
+            logging::write(tf_log_site_, (level), __VA_ARGS__); \
+        } \
+    } while(0)
+
+#define LOG_DEBUG(...) TF_LOG(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)  TF_LOG(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...)  TF_LOG(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) TF_LOG(LOG_LEVEL_ERROR, __VA_ARGS__)
@@ -0,0 +1,278 @@
+// Process metrics in Prometheus text format, served on 127.0.0.1:<port>/metrics.
+// Recording is a relaxed fetch_add on a per-thread shard (each shard on its
+// own cache line), so the hot path never contends or takes a lock; the
+// shards are only summed when the endpoint is scraped. Metric objects are
+// constant-initialized and can be used before main (allocation counting).
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace metrics_detail {
+
+constexpr int SHARDS = 16;
+
+// Threads get shards round-robin on first use
+inline int shard_index(){
+    static std::atomic<int> next{ 0 };
+    thread_local int idx = -1;
+    if(idx < 0) idx = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return idx;
+}
+
+inline void append(std::string& out, const char* fmt, ...){
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if(n > 0) out.append(buf, std::min(n, (int)sizeof(buf) - 1));
+}
+
+// name{labels} or name{labels,extra}
+inline std::string series(const char* name, const char* suffix, const char* labels, const char* extra = nullptr){
+    std::string s = std::string(name) + suffix;
+    bool l = labels && *labels, e = extra && *extra;
+    if(l || e) s += "{" + std::string(l ? labels : "") + (l && e ? "," : "") + (e ? extra : "") + "}";
+    return s;
+}
+
+} // namespace metrics_detail
+
+struct Metric {
+    virtual const char* type() const = 0;
+    virtual void write(std::string& out, const char* name, const char* labels) const = 0;
+};
+
+struct MetricCounter : Metric {
+    struct alignas(64) Shard { std::atomic<uint64_t> v{ 0 }; };
+    Shard shards[metrics_detail::SHARDS];
+
+    void add(uint64_t n = 1){ shards[metrics_detail::shard_index()].v.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const {
+        uint64_t sum = 0;
+        for(const Shard& s : shards) sum += s.v.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    const char* type() const override { return "counter"; }
+    void write(std::string& out, const char* name, const char* labels) const override {
+        metrics_detail::append(out, "%s %llu\n", metrics_detail::series(name, "", labels).c_str(), (unsigned long long)value());
+    }
+};
+
+struct MetricGauge : Metric {
+    std::atomic<int64_t> v{ 0 };
+
+    void set(int64_t x){ v.store(x, std::memory_order_relaxed); }
+    void add(int64_t n){ v.fetch_add(n, std::memory_order_relaxed); }
+
+    const char* type() const override { return "gauge"; }
+    void write(std::string& out, const char* name, const char* labels) const override {
+        metrics_detail::append(out, "%s %lld\n", metrics_detail::series(name, "", labels).c_str(), (long long)v.load(std::memory_order_relaxed));
+    }
+};
+
+// Durations in seconds; buckets from 0.5 ms to 1 s, sum kept in nanoseconds
+struct MetricHistogram : Metric {
+    static constexpr int BUCKETS = 12;
+    static constexpr double BOUNDS[BUCKETS] = { 0.0005, 0.001, 0.002, 0.004, 0.008, 0.0125, 0.0167, 0.025, 0.0333, 0.05, 0.1, 1.0 };
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> buckets[BUCKETS + 1] = {}; // last = +Inf
+        std::atomic<uint64_t> sumNs{ 0 };
+    };
+    Shard shards[metrics_detail::SHARDS];
+
+    void observe(double seconds){
+        int b = 0;
+        while(b < BUCKETS && seconds > BOUNDS[b]) ++b;
+        Shard& s = shards[metrics_detail::shard_index()];
+        s.buckets[b].fetch_add(1, std::memory_order_relaxed);
+        s.sumNs.fetch_add((uint64_t)(seconds > 0.0 ? seconds * 1e9 : 0.0), std::memory_order_relaxed);
+    }
+
+    const char* type() const override { return "histogram"; }
+    void write(std::string& out, const char* name, const char* labels) const override {
+        using namespace metrics_detail;
+        uint64_t counts[BUCKETS + 1] = {}, sumNs = 0;
+        for(const Shard& s : shards){
+            for(int b = 0; b <= BUCKETS; ++b) counts[b] += s.buckets[b].load(std::memory_order_relaxed);
+            sumNs += s.sumNs.load(std::memory_order_relaxed);
+        }
+        uint64_t cumulative = 0;
+        char le[32];
+        for(int b = 0; b <= BUCKETS; ++b){
+            cumulative += counts[b];
+            if(b < BUCKETS) snprintf(le, sizeof(le), "le=\"%g\"", BOUNDS[b]);
+            else snprintf(le, sizeof(le), "le=\"+Inf\"");
+            append(out, "%s %llu\n", series(name, "_bucket", labels, le).c_str(), (unsigned long long)cumulative);
+        }
+        append(out, "%s %.9f\n", series(name, "_sum", labels).c_str(), sumNs / 1e9);
+        append(out, "%s %llu\n", series(name, "_count", labels).c_str(), (unsigned long long)cumulative);
+    }
+};
+
+struct MetricRegistry {
+    struct Entry {
+        const char* name;
+        const char* labels; // e.g. team="blue", or ""
+        const char* help;
+        const Metric* metric;
+    };
+    std::vector<Entry> entries;
+
+    void add(const char* name, const char* help, const Metric& m, const char* labels = ""){
+        entries.push_back({ name, labels, help, &m });
+    }
+
+    // HELP/TYPE once per family, series in registration order
+    std::string render() const {
+        std::string out;
+        for(size_t i = 0; i < entries.size(); ++i){
+            const Entry& e = entries[i];
+            bool first = true;
+            for(size_t j = 0; j < i && first; ++j) first = strcmp(entries[j].name, e.name) != 0;
+            if(first){
+                metrics_detail::append(out, "# HELP %s %s\n", e.name, e.help);
+                metrics_detail::append(out, "# TYPE %s %s\n", e.name, e.metric->type());
+            }
+            e.metric->write(out, e.name, e.labels);
+        }
+        return out;
+    }
+};
+
+// Single-threaded HTTP/1.0-style responder on its own thread, localhost only
+struct MetricsServer {
+#ifdef _WIN32
+    using Socket = SOCKET;
+    static constexpr Socket NO_SOCKET = INVALID_SOCKET;
+    static void close_socket(Socket s){ closesocket(s); }
+#else
+    using Socket = int;
+    static constexpr Socket NO_SOCKET = -1;
+    static void close_socket(Socket s){ close(s); }
+#endif
+#ifdef MSG_NOSIGNAL
+    static constexpr int SEND_FLAGS = MSG_NOSIGNAL; // scraper hung up: no SIGPIPE
+#else
+    static constexpr int SEND_FLAGS = 0;
+#endif
+
+    const MetricRegistry* registry = nullptr;
+    Socket listener = NO_SOCKET;
+    std::thread worker;
+    std::atomic<bool> quit{ false };
+
+    ~MetricsServer(){ stop(); }
+
+    bool start(const MetricRegistry& reg, int port){
+        registry = &reg;
+#ifdef _WIN32
+        WSADATA wsa;
+        if(WSAStartup(MAKEWORD(2, 2), &wsa) != 0){ LOG_ERROR("Metrics: WSAStartup failed"); return false; }
+#endif
+        listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if(listener == NO_SOCKET){ LOG_ERROR("Metrics: socket() failed"); return false; }
+        int yes = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&yes, sizeof(yes));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if(bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 8) != 0){
+            LOG_ERROR("Metrics: cannot listen on 127.0.0.1:%d", port);
+            close_socket(listener);
+            listener = NO_SOCKET;
+            return false;
+        }
+        quit = false;
+        worker = std::thread([this]{ run(); });
+        LOG_INFO("Metrics: http://127.0.0.1:%d/metrics", port);
+        return true;
+    }
+
+    void stop(){
+        if(!worker.joinable()) return;
+        quit = true;
+        worker.join();
+        close_socket(listener);
+        listener = NO_SOCKET;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+private:
+    // Wait up to ms for data, so the loop can still notice quit
+    static bool readable(Socket s, int ms){
+#ifdef _WIN32
+        WSAPOLLFD p = { s, POLLRDNORM, 0 };
+        return WSAPoll(&p, 1, ms) > 0;
+#else
+        pollfd p = { s, POLLIN, 0 };
+        return poll(&p, 1, ms) > 0;
+#endif
+    }
+
+    void run(){
+        while(!quit){
+            if(!readable(listener, 200)) continue;
+            Socket c = accept(listener, nullptr, nullptr);
+            if(c == NO_SOCKET) continue;
+            serve(c);
+            close_socket(c);
+        }
+    }
+
+    void serve(Socket c){
+        char req[2048];
+        int got = 0;
+        while(got < (int)sizeof(req) - 1 && readable(c, 1000)){
+            int n = (int)recv(c, req + got, (int)sizeof(req) - 1 - got, 0);
+            if(n <= 0) break;
+            got += n;
+            req[got] = 0;
+            if(strstr(req, "\r\n\r\n")) break;
+        }
+        req[got] = 0;
+
+        std::string body, head;
+        if(strncmp(req, "GET /metrics", 12) == 0 || strncmp(req, "GET / ", 6) == 0){
+            body = registry->render();
+            head = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+        } else {
+            body = "not found\n";
+            head = "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\n";
+        }
+        head += "Content-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+        std::string resp = head + body;
+        for(size_t sent = 0; sent < resp.size();){
+            int n = (int)send(c, resp.data() + sent, (int)(resp.size() - sent), SEND_FLAGS);
+            if(n <= 0) break;
+            sent += (size_t)n;
+        }
+    }
+};
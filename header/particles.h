@@ -0,0 +1,178 @@
+// Particle effects: turf spray on kicks, dust on bounces, confetti on goals.
+// Fixed-capacity structure-of-arrays pool, SIMD integration (SSE2 when
+// available), one geometry call per frame for every live particle.
+// Spawning is capped per frame so a stress match cannot blow the budget.
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TF_PARTICLES_SSE2 1
+#endif
+
+#include "canvas.h"
+#include "sim_events.h"
+
+struct ParticlePool {
+    static constexpr int CAPACITY = 2048;         // multiple of 4 (SIMD lanes)
+    static constexpr int DEFAULT_BUDGET = 256;    // max spawns per frame
+
+    // SoA storage
+    alignas(16) float x[CAPACITY];
+    alignas(16) float y[CAPACITY];
+    alignas(16) float vx[CAPACITY];
+    alignas(16) float vy[CAPACITY];
+    alignas(16) float ay[CAPACITY];      // screen-down acceleration (confetti falls)
+    alignas(16) float drag[CAPACITY];    // linear damping per second
+    alignas(16) float life[CAPACITY];    // seconds left
+    alignas(16) float invLife[CAPACITY]; // 1 / initial life, for the alpha fade
+    alignas(16) float size[CAPACITY];
+    SDL_Color color[CAPACITY];
+
+    int count = 0;
+    int budget = DEFAULT_BUDGET;   // spawns allowed per frame
+    int spawnedThisFrame = 0;
+    int rejectedThisFrame = 0;     // spawns refused by budget/capacity
+    uint32_t rng = 0x9E3779B9u;    // visual only, independent of match randomness
+
+    // Vertex/index buffers sized once, reused every frame
+    std::vector<SDL_Vertex> verts;
+    std::vector<int> indices;
+
+    ParticlePool(){
+        for(int i = 0; i < CAPACITY; ++i){
+            x[i] = y[i] = vx[i] = vy[i] = ay[i] = drag[i] = life[i] = invLife[i] = size[i] = 0.0f;
+            color[i] = {0, 0, 0, 0};
+        }
+        verts.resize(CAPACITY * 4);
+        indices.resize(CAPACITY * 6);
+        for(int i = 0; i < CAPACITY; ++i){
+            int* q = &indices[i * 6];
+            q[0] = i*4; q[1] = i*4 + 1; q[2] = i*4 + 2;
+            q[3] = i*4; q[4] = i*4 + 2; q[5] = i*4 + 3;
+        }
+    }
+
+    void begin_frame(){ spawnedThisFrame = 0; rejectedThisFrame = 0; }
+
+    bool spawn(float px, float py, float pvx, float pvy, float pay, float pdrag,
+               float plife, float psize, SDL_Color c){
+        if(count >= CAPACITY || spawnedThisFrame >= budget){ ++rejectedThisFrame; return false; }
+        int i = count++;
+        x[i] = px; y[i] = py; vx[i] = pvx; vy[i] = pvy; ay[i] = pay; drag[i] = pdrag;
+        life[i] = plife; invLife[i] = 1.0f / plife; size[i] = psize; color[i] = c;
+        ++spawnedThisFrame;
+        return true;
+    }
+
+    // ---- Effects ----
+    void emit_kick(float px, float py, float dx, float dy){
+        // turf spray opposite to the kick direction
+        for(int i = 0; i < 10; ++i){
+            float a = atan2f(-dy, -dx) + frand(-0.7f, 0.7f);
+            float s = frand(60.0f, 160.0f);
+            Uint8 g = (Uint8)frand(110.0f, 170.0f);
+            SDL_Color c = (i % 3 == 0) ? SDL_Color{110, 80, 40, 220} : SDL_Color{40, g, 40, 230};
+            spawn(px, py, cosf(a) * s, sinf(a) * s, 0.0f, 4.0f, frand(0.25f, 0.45f), frand(2.0f, 4.0f), c);
+        }
+    }
+
+    void emit_bounce(float px, float py, float nx, float ny){
+        for(int i = 0; i < 6; ++i){
+            float a = atan2f(ny, nx) + frand(-1.1f, 1.1f);
+            float s = frand(30.0f, 90.0f);
+            spawn(px, py, cosf(a) * s, sinf(a) * s, 0.0f, 3.0f, frand(0.3f, 0.5f), frand(3.0f, 5.0f),
+                  SDL_Color{225, 215, 185, 160});
+        }
+    }
+
+    void emit_goal(float px, float py, int team){
+        static const SDL_Color palette[] = {
+            {255, 235, 59, 255}, {255, 255, 255, 255}, {244, 67, 54, 255}, {76, 175, 80, 255},
+        };
+        SDL_Color teamColor = (team == 0) ? SDL_Color{80, 150, 255, 255} : SDL_Color{255, 120, 60, 255};
+        for(int i = 0; i < 120; ++i){
+            float a = frand(0.0f, 6.2831853f);
+            float s = frand(80.0f, 340.0f);
+            SDL_Color c = (i % 2 == 0) ? teamColor : palette[i % 4];
+            spawn(px, py, cosf(a) * s, sinf(a) * s - 120.0f, 260.0f, 1.5f, frand(1.0f, 1.8f), frand(3.0f, 6.0f), c);
+        }
+    }
+
+    void emit_from(const SimEventQueue& events){
+        for(const SimEvent& e : events){
+            switch(e.type){
+                case SimEventType::Kick:         emit_kick(e.x, e.y, e.dx, e.dy); break;
+                case SimEventType::WallBounce:
+                case SimEventType::PlayerBounce: emit_bounce(e.x, e.y, e.dx, e.dy); break;
+                case SimEventType::Goal:         emit_goal(e.x, e.y, e.team); break;
+            }
+        }
+    }
+
+    // ---- Simulation ----
+    void update(float dt){
+        const int n = (count + 3) & ~3; // padding lanes past count are ignored afterwards
+#ifdef TF_PARTICLES_SSE2
+        const __m128 vdt  = _mm_set1_ps(dt);
+        const __m128 one  = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        for(int i = 0; i < n; i += 4){
+            __m128 damp = _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(_mm_load_ps(drag + i), vdt)));
+            __m128 pvx = _mm_mul_ps(_mm_load_ps(vx + i), damp);
+            __m128 pvy = _mm_add_ps(_mm_mul_ps(_mm_load_ps(vy + i), damp), _mm_mul_ps(_mm_load_ps(ay + i), vdt));
+            _mm_store_ps(vx + i, pvx);
+            _mm_store_ps(vy + i, pvy);
+            _mm_store_ps(x + i, _mm_add_ps(_mm_load_ps(x + i), _mm_mul_ps(pvx, vdt)));
+            _mm_store_ps(y + i, _mm_add_ps(_mm_load_ps(y + i), _mm_mul_ps(pvy, vdt)));
+            _mm_store_ps(life + i, _mm_sub_ps(_mm_load_ps(life + i), vdt));
+        }
+#else
+        for(int i = 0; i < n; ++i){
+            float damp = 1.0f - drag[i] * dt;
+            if(damp < 0.0f) damp = 0.0f;
+            vx[i] *= damp;
+            vy[i] = vy[i] * damp + ay[i] * dt;
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+            life[i] -= dt;
+        }
+#endif
+        // swap-remove dead particles (order does not matter)
+        for(int i = 0; i < count; ){
+            if(life[i] > 0.0f){ ++i; continue; }
+            int last = --count;
+            x[i] = x[last]; y[i] = y[last]; vx[i] = vx[last]; vy[i] = vy[last];
+            ay[i] = ay[last]; drag[i] = drag[last]; life[i] = life[last];
+            invLife[i] = invLife[last]; size[i] = size[last]; color[i] = color[last];
+        }
+    }
+
+    // ---- Rendering: one batched draw ----
+    void render(Canvas& canvas){
+        if(count == 0) return;
+        for(int i = 0; i < count; ++i){
+            float h = size[i] * 0.5f;
+            SDL_Color c = color[i];
+            float fade = life[i] * invLife[i];
+            c.a = (Uint8)(c.a * (fade < 1.0f ? fade : 1.0f));
+            SDL_Vertex* v = &verts[i * 4];
+            v[0] = { { x[i] - h, y[i] - h }, c, { 0, 0 } };
+            v[1] = { { x[i] + h, y[i] - h }, c, { 0, 0 } };
+            v[2] = { { x[i] + h, y[i] + h }, c, { 0, 0 } };
+            v[3] = { { x[i] - h, y[i] + h }, c, { 0, 0 } };
+        }
+        canvas.geometry(verts.data(), count * 4, indices.data(), count * 6);
+    }
+
+private:
+    float frand(float a, float b){
+        // xorshift32
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+        return a + (b - a) * ((rng >> 8) * (1.0f / 16777216.0f));
+    }
+};
@@ -0,0 +1,151 @@
+// Pass-lane and shot-window evaluation: for a ball kicked from one point
+// towards each of a set of targets (teammates, points on the goal mouth),
+// how much earlier the ball gets past every opponent than the opponent can
+// get to it. One pass over the opponents scores all targets: targets sit
+// four to an SSE register, each opponent is broadcast.
+//
+// Per target and opponent: the closest point of the lane to the opponent,
+// the ball's time to get there (kick speed with the per-tick friction of
+// Ball, t = -ln(1 - s k / v0) / k) and the opponent's time to run there
+// (distance minus reach, at run speed). The lane's margin is the smallest
+// "opponent time - ball time" over all opponents, in seconds: negative
+// means someone gets there first. Lanes the ball cannot roll to the end of
+// get -INFINITY.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TF_LANES_SSE2 1
+#endif
+
+struct LaneParams {
+    float kickSpeed = 450.0f;  // px/s right after the kick
+    float decay = 1.2122f;     // 1/s, -ln(Ball::FRICTION_PER_SEC) * 60
+    float runSpeed = 260.0f;   // px/s, opponents
+    float reach = 30.0f;       // px, opponent touches the ball this close
+};
+
+struct LaneEvaluator {
+    static constexpr int MAX_TARGETS = 32;
+    static constexpr int MAX_OPPONENTS = 32;
+    static constexpr float MAX_ROLL = 0.97f; // fraction of the rolling distance a lane may use
+
+    alignas(16) float tx[MAX_TARGETS], ty[MAX_TARGETS];
+    alignas(16) float ox[MAX_OPPONENTS], oy[MAX_OPPONENTS];
+    alignas(16) float margin[MAX_TARGETS];
+    int targets = 0, opponents = 0;
+
+    void clear(){ targets = opponents = 0; }
+    bool add_target(float x, float y){
+        if(targets == MAX_TARGETS) return false;
+        tx[targets] = x; ty[targets] = y; ++targets;
+        return true;
+    }
+    bool add_opponent(float x, float y){
+        if(opponents == MAX_OPPONENTS) return false;
+        ox[opponents] = x; oy[opponents] = y; ++opponents;
+        return true;
+    }
+
+    // margin[i] for every target, ball kicked from (fromX, fromY)
+    void evaluate(float fromX, float fromY, const LaneParams& lp){
+        prepare(fromX, fromY, lp);
+#ifdef TF_LANES_SSE2
+        evaluate_sse2(fromX, fromY, lp);
+#else
+        evaluate_scalar(fromX, fromY, lp);
+#endif
+        finish();
+    }
+
+    // Same result without SIMD (reference for --bench-lanes)
+    void evaluate_reference(float fromX, float fromY, const LaneParams& lp){
+        prepare(fromX, fromY, lp);
+        evaluate_scalar(fromX, fromY, lp);
+        finish();
+    }
+
+    // 0 (someone is there first) .. 1 (safeSeconds or more to spare)
+    static float score(float m, float safeSeconds = 0.4f){
+        return m == -INFINITY ? 0.0f : std::clamp(m / safeSeconds, 0.0f, 1.0f);
+    }
+
+private:
+    // Per target: unit direction and length, padded to a multiple of 4
+    alignas(16) float ux[MAX_TARGETS], uy[MAX_TARGETS], len[MAX_TARGETS];
+    bool reachable[MAX_TARGETS];
+
+    void prepare(float fromX, float fromY, const LaneParams& lp){
+        const float maxLen = lp.kickSpeed / lp.decay * MAX_ROLL;
+        const int padded = (targets + 3) & ~3;
+        for(int i = 0; i < padded; ++i){
+            float dx = i < targets ? tx[i] - fromX : 0.0f, dy = i < targets ? ty[i] - fromY : 0.0f;
+            float l = std::sqrt(dx*dx + dy*dy);
+            reachable[i] = l <= maxLen;
+            len[i] = std::min(l, maxLen);
+            ux[i] = l > 1e-4f ? dx / l : 0.0f;
+            uy[i] = l > 1e-4f ? dy / l : 0.0f;
+        }
+    }
+
+    void finish(){
+        for(int i = 0; i < targets; ++i) if(!reachable[i]) margin[i] = -INFINITY;
+    }
+
+    void evaluate_scalar(float fromX, float fromY, const LaneParams& lp){
+        const float kv = lp.decay / lp.kickSpeed, invK = 1.0f / lp.decay, invRun = 1.0f / lp.runSpeed;
+        for(int i = 0; i < targets; ++i){
+            float best = INFINITY;
+            for(int j = 0; j < opponents; ++j){
+                float rx = ox[j] - fromX, ry = oy[j] - fromY;
+                float s = std::clamp(rx*ux[i] + ry*uy[i], 0.0f, len[i]);
+                float qx = ux[i]*s - rx, qy = uy[i]*s - ry;
+                float run = std::max(std::sqrt(qx*qx + qy*qy) - lp.reach, 0.0f) * invRun;
+                float ball = -std::log(1.0f - s * kv) * invK;
+                best = std::min(best, run - ball);
+            }
+            margin[i] = best;
+        }
+    }
+
+#ifdef TF_LANES_SSE2
+    // ln(x) for x in (0, 1]: exponent plus a degree-5 polynomial for ln(1 + u),
+    // u in [0, 1) (Abramowitz & Stegun 4.1.43, |error| < 1e-5)
+    static __m128 log_ps(__m128 x){
+        const __m128i bits = _mm_castps_si128(x);
+        const __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+        const __m128 u = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)),
+                                                                  _mm_set1_epi32(0x3F800000))), _mm_set1_ps(1.0f));
+        __m128 p = _mm_set1_ps(0.03215845f);
+        p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(-0.13606275f));
+        p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(0.28947478f));
+        p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(-0.49190896f));
+        p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(0.99949556f));
+        return _mm_add_ps(_mm_mul_ps(e, _mm_set1_ps(0.69314718f)), _mm_mul_ps(p, u));
+    }
+
+    void evaluate_sse2(float fromX, float fromY, const LaneParams& lp){
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+        const __m128 kv = _mm_set1_ps(lp.decay / lp.kickSpeed), invK = _mm_set1_ps(1.0f / lp.decay);
+        const __m128 invRun = _mm_set1_ps(1.0f / lp.runSpeed), reach = _mm_set1_ps(lp.reach);
+        for(int i = 0; i < targets; i += 4){
+            const __m128 dx = _mm_load_ps(ux + i), dy = _mm_load_ps(uy + i), l = _mm_load_ps(len + i);
+            __m128 best = _mm_set1_ps(INFINITY);
+            for(int j = 0; j < opponents; ++j){
+                const __m128 rx = _mm_set1_ps(ox[j] - fromX), ry = _mm_set1_ps(oy[j] - fromY);
+                __m128 s = _mm_add_ps(_mm_mul_ps(rx, dx), _mm_mul_ps(ry, dy));
+                s = _mm_min_ps(_mm_max_ps(s, zero), l);
+                const __m128 qx = _mm_sub_ps(_mm_mul_ps(dx, s), rx), qy = _mm_sub_ps(_mm_mul_ps(dy, s), ry);
+                const __m128 d = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)));
+                const __m128 run = _mm_mul_ps(_mm_max_ps(_mm_sub_ps(d, reach), zero), invRun);
+                const __m128 ball = _mm_mul_ps(log_ps(_mm_sub_ps(one, _mm_mul_ps(s, kv))), invK); // = -time
+                best = _mm_min_ps(best, _mm_add_ps(run, ball));
+            }
+            _mm_store_ps(margin + i, best);
+        }
+    }
+#endif
+};
@@ -0,0 +1,119 @@
+// Pitch geometry: one constexpr description of the field shared by
+// physics (walls), scoring (goal lines), AI (positioning) and rendering.
+#pragma once
+
+// Screen
+constexpr int SCREEN_W = 1300;
+constexpr int SCREEN_H = 800;
+
+struct PitchPoint {
+    float x, y;
+};
+
+struct PitchRect {
+    float x, y, w, h;
+
+    constexpr float left()    const { return x; }
+    constexpr float right()   const { return x + w; }
+    constexpr float top()     const { return y; }
+    constexpr float bottom()  const { return y + h; }
+    constexpr float centerX() const { return x + w * 0.5f; }
+    constexpr float centerY() const { return y + h * 0.5f; }
+    constexpr bool contains(float px, float py) const {
+        return px >= x && px <= x + w && py >= y && py <= y + h;
+    }
+};
+
+// Khung thành: vạch cầu môn + hai cột dọc
+struct GoalMouth {
+    float lineX;      // goal line, the ball's leading edge must cross it
+    float top;        // upper post (y)
+    float bottom;     // lower post (y)
+    float inward;     // +1 if the field lies to the right of lineX (left goal), -1 otherwise
+    PitchRect sprite; // where the goal sprite is drawn
+
+    constexpr float height()   const { return bottom - top; }
+    constexpr float centerY()  const { return (top + bottom) * 0.5f; }
+    constexpr PitchPoint postTop()    const { return { lineX, top }; }
+    constexpr PitchPoint postBottom() const { return { lineX, bottom }; }
+    // A ball of radius r centred at y overlaps the mouth between the posts
+    constexpr bool spans(float y, float r) const { return y + r >= top && y - r <= bottom; }
+    // Squared distance from (x, y) to the mouth, the segment between the posts
+    constexpr float distanceSq(float x, float y) const {
+        const float dx = x - lineX;
+        const float dy = y < top ? top - y : (y > bottom ? y - bottom : 0.0f);
+        return dx * dx + dy * dy;
+    }
+};
+
+struct PitchGeometry {
+    PitchRect  bounds;          // walls the ball bounces off / players are clamped to
+    PitchRect  touchlines;      // painted outer lines
+    PitchPoint centerSpot;
+    float      centerCircleR;
+    GoalMouth  goals[2];        // [0] left goal (Blue defends), [1] right goal (Red defends)
+    PitchRect  penaltyArea[2];
+    PitchRect  goalArea[2];
+    PitchPoint penaltySpot[2];
+    float      penaltyArcR;
+};
+
+// Mirror a left-side feature onto the right half of the screen
+constexpr PitchRect pitch_mirror(PitchRect r){ return { SCREEN_W - r.x - r.w, r.y, r.w, r.h }; }
+constexpr PitchPoint pitch_mirror(PitchPoint p){ return { SCREEN_W - p.x, p.y }; }
+
+// Kích thước khung thành (trước đây tính lại mỗi frame: SCREEN_H * 0.15 * 0.8)
+constexpr float GOAL_MOUTH_H = 96.0f;
+constexpr float GOAL_LINE_X  = 80.0f;
+
+// Line positions follow the painted field so rendering and logic agree
+constexpr PitchRect LEFT_PENALTY_AREA = { 102.0f, 150.0f, 217.0f, 497.0f };
+constexpr PitchRect LEFT_GOAL_AREA    = { 102.0f, 284.0f,  73.0f, 227.0f };
+constexpr PitchPoint LEFT_PENALTY_SPOT = { 245.0f, SCREEN_H * 0.5f - 2.0f };
+
+constexpr PitchGeometry PITCH = {
+    /* bounds        */ { 0.0f, 0.0f, (float)SCREEN_W, (float)SCREEN_H },
+    /* touchlines    */ { 102.0f, 54.0f, SCREEN_W - 204.0f, 688.0f },
+    /* centerSpot    */ { SCREEN_W * 0.5f, SCREEN_H * 0.5f - 2.0f },
+    /* centerCircleR */ 118.0f,
+    /* goals */ {
+        { GOAL_LINE_X,
+          SCREEN_H * 0.5f - GOAL_MOUTH_H * 0.5f, SCREEN_H * 0.5f + GOAL_MOUTH_H * 0.5f,
+          +1.0f, { 39.0f, SCREEN_H * 0.5f - GOAL_MOUTH_H * 0.5f, 60.0f, 100.0f } },
+        { SCREEN_W - GOAL_LINE_X,
+          SCREEN_H * 0.5f - GOAL_MOUTH_H * 0.5f, SCREEN_H * 0.5f + GOAL_MOUTH_H * 0.5f,
+          -1.0f, { SCREEN_W - 96.0f, SCREEN_H * 0.5f - GOAL_MOUTH_H * 0.5f, 60.0f, 100.0f } },
+    },
+    /* penaltyArea   */ { LEFT_PENALTY_AREA, pitch_mirror(LEFT_PENALTY_AREA) },
+    /* goalArea      */ { LEFT_GOAL_AREA,    pitch_mirror(LEFT_GOAL_AREA) },
+    /* penaltySpot   */ { LEFT_PENALTY_SPOT, pitch_mirror(LEFT_PENALTY_SPOT) },
+    /* penaltyArcR   */ 122.0f,
+};
+
+static_assert(PITCH.goals[0].top > PITCH.bounds.top() && PITCH.goals[0].bottom < PITCH.bounds.bottom(),
+              "goal mouth must lie inside the pitch bounds");
+static_assert(PITCH.goals[0].lineX < PITCH.goals[1].lineX, "left goal line must be left of right goal line");
+
+// Goal-line crossing for a ball of radius r whose centre moved (px,py) -> (cx,cy) this tick.
+// Returns 0 if no goal, 1 if it crossed the left goal line between the posts,
+// 2 for the right goal line. Checking the swept segment (not only the end
+// position) means a fast ball cannot tunnel past the line in one tick.
+constexpr int goal_line_crossed(const PitchGeometry& g, float px, float py, float cx, float cy, float r){
+    for(int i = 0; i < 2; ++i){
+        const GoalMouth& m = g.goals[i];
+        // signed distance of the leading edge in front of the line (positive = still on the field)
+        float before = (px - r * m.inward - m.lineX) * m.inward;
+        float after  = (cx - r * m.inward - m.lineX) * m.inward;
+        if(before > 0.0f && after <= 0.0f){
+            float t = before / (before - after);
+            float y = py + (cy - py) * t;
+            if(m.spans(y, r)) return i + 1;
+        }
+    }
+    return 0;
+}
+
+static_assert(goal_line_crossed(PITCH, 100.0f, 400.0f, 80.0f, 400.0f, 10.0f) == 1, "left goal");
+static_assert(goal_line_crossed(PITCH, 1200.0f, 400.0f, 1215.0f, 400.0f, 10.0f) == 2, "right goal");
+static_assert(goal_line_crossed(PITCH, 100.0f, 100.0f, 80.0f, 100.0f, 10.0f) == 0, "wide of the post");
+static_assert(goal_line_crossed(PITCH, 60.0f, 400.0f, 50.0f, 400.0f, 10.0f) == 0, "already behind the line");
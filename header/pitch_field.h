@@ -0,0 +1,110 @@
+// Pitch distance field: signed distances to the walls, goal mouths and posts
+// baked once from PITCH into a coarse grid. Queries are a bilinear lookup
+// (O(1), no branching on geometry) and also return the field gradient,
+// which is the outward/inward normal used for bounces.
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "pitch.h"
+
+struct FieldSample {
+    float dist;    // interpolated distance (px)
+    float nx, ny;  // normalised gradient: direction in which dist grows
+};
+
+struct PitchField {
+    static constexpr int   CELL   = 8;                  // px per grid sample
+    static constexpr int   MARGIN = 8;                  // extra cells around the screen (64px)
+    static constexpr int   GW     = SCREEN_W / CELL + 1 + 2 * MARGIN;
+    static constexpr int   GH     = SCREEN_H / CELL + 1 + 2 * MARGIN;
+    static constexpr float QUANT  = 8.0f;               // stored as int16 in 1/8 px
+
+    enum Channel { WALL = 0, MOUTH = 1, POST = 2, CHANNELS = 3 };
+
+    // Interleaved channels so one sample touches one cache line per row
+    int16_t data[GH][GW][CHANNELS];
+
+    void bake(const PitchGeometry& g){
+        for(int gy = 0; gy < GH; ++gy){
+            for(int gx = 0; gx < GW; ++gx){
+                float x = (float)((gx - MARGIN) * CELL);
+                float y = (float)((gy - MARGIN) * CELL);
+                store(gx, gy, WALL,  rect_inside_distance(g.bounds, x, y));
+                float mouth = 1e9f, post = 1e9f;
+                for(const GoalMouth& m : g.goals){
+                    mouth = std::min(mouth, segment_distance(x, y, m.lineX, m.top, m.lineX, m.bottom));
+                    post  = std::min(post, std::hypot(x - m.lineX, y - m.top));
+                    post  = std::min(post, std::hypot(x - m.lineX, y - m.bottom));
+                }
+                store(gx, gy, MOUTH, mouth);
+                store(gx, gy, POST,  post);
+            }
+        }
+    }
+
+    // Bilinear sample of one channel plus its gradient
+    FieldSample sample(Channel ch, float x, float y) const {
+        float fx = clampf_(x / CELL + MARGIN, 0.0f, GW - 1.001f);
+        float fy = clampf_(y / CELL + MARGIN, 0.0f, GH - 1.001f);
+        int ix = (int)fx, iy = (int)fy;
+        float tx = fx - ix, ty = fy - iy;
+
+        float v00 = data[iy    ][ix    ][ch] / QUANT;
+        float v10 = data[iy    ][ix + 1][ch] / QUANT;
+        float v01 = data[iy + 1][ix    ][ch] / QUANT;
+        float v11 = data[iy + 1][ix + 1][ch] / QUANT;
+
+        float top = v00 + (v10 - v00) * tx;
+        float bot = v01 + (v11 - v01) * tx;
+
+        FieldSample s;
+        s.dist = top + (bot - top) * ty;
+        float gx = ((v10 - v00) * (1.0f - ty) + (v11 - v01) * ty);
+        float gy = (bot - top);
+        float len = std::sqrt(gx*gx + gy*gy);
+        if(len > 1e-6f){ s.nx = gx / len; s.ny = gy / len; }
+        else           { s.nx = 0.0f;     s.ny = 0.0f; }
+        return s;
+    }
+
+    // Positive inside the walls, negative outside; normal points back into the pitch
+    FieldSample wall(float x, float y)  const { return sample(WALL,  x, y); }
+    // Distance to the nearest goal mouth (segment between the posts)
+    FieldSample mouth(float x, float y) const { return sample(MOUTH, x, y); }
+    // Distance to the nearest goal post
+    FieldSample post(float x, float y)  const { return sample(POST,  x, y); }
+
+private:
+    static float clampf_(float v, float a, float b){ return v < a ? a : (v > b ? b : v); }
+
+    void store(int gx, int gy, Channel ch, float d){
+        data[gy][gx][ch] = (int16_t)clampf_(std::round(d * QUANT), -32767.0f, 32767.0f);
+    }
+
+    static float rect_inside_distance(const PitchRect& r, float x, float y){
+        float dx = std::max(r.left() - x, x - r.right());
+        float dy = std::max(r.top() - y,  y - r.bottom());
+        if(dx <= 0.0f && dy <= 0.0f) return -std::max(dx, dy);   // inside: distance to nearest wall
+        return -std::hypot(std::max(dx, 0.0f), std::max(dy, 0.0f));
+    }
+
+    static float segment_distance(float px, float py, float ax, float ay, float bx, float by){
+        float abx = bx - ax, aby = by - ay;
+        float t = ((px - ax) * abx + (py - ay) * aby) / (abx*abx + aby*aby);
+        t = clampf_(t, 0.0f, 1.0f);
+        return std::hypot(px - (ax + abx * t), py - (ay + aby * t));
+    }
+};
+
+// Baked on first use (Game::init touches it so the cost is paid at startup)
+inline const PitchField& pitch_field(){
+    static const PitchField* field = []{
+        PitchField* f = new PitchField();
+        f->bake(PITCH);
+        return f;
+    }();
+    return *field;
+}
@@ -0,0 +1,144 @@
+// Pitch background built at startup: one grass tile from the Kenney
+// tilesheet repeated over the target size, then the markings painted from
+// PITCH. Lines are anti-aliased coverage accumulated into a mask first, so
+// overlapping markings (box edges on the touchline) do not double up.
+// Replaces decoding and stretching the full-size field JPG. `scale` paints
+// the same PITCH at another output resolution (export, SVG art).
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "pitch.h"
+
+// Plain mown-grass tile in Tilesheet/groundGrass_mownWide.png (64 px grid)
+constexpr SDL_Rect GRASS_TILE = { 0, 0, 64, 64 };
+
+struct PitchPainter {
+    int w, h;
+    float s;                   // PITCH units -> mask pixels
+    std::vector<uint8_t> mask; // line coverage 0..255
+
+    PitchPainter(int width, int height, float scale = 1.0f)
+        : w(width), h(height), s(scale), mask((size_t)width * height, 0) {}
+
+    void cover(int x, int y, float c){
+        if(x < 0 || y < 0 || x >= w || y >= h || c <= 0.0f) return;
+        uint8_t v = (uint8_t)(std::min(c, 1.0f) * 255.0f + 0.5f);
+        uint8_t& m = mask[(size_t)y * w + x];
+        if(v > m) m = v;
+    }
+
+    // Axis-aligned box, exact area coverage on the edges
+    void box(float x0, float y0, float x1, float y1){
+        x0 *= s; y0 *= s; x1 *= s; y1 *= s;
+        for(int y = (int)std::floor(y0); y < (int)std::ceil(y1); ++y){
+            float cy = std::min(y + 1.0f, y1) - std::max((float)y, y0);
+            for(int x = (int)std::floor(x0); x < (int)std::ceil(x1); ++x){
+                float cx = std::min(x + 1.0f, x1) - std::max((float)x, x0);
+                cover(x, y, cx * cy);
+            }
+        }
+    }
+
+    void hline(float x0, float x1, float y, float t){ box(x0 - t * 0.5f, y - t * 0.5f, x1 + t * 0.5f, y + t * 0.5f); }
+    void vline(float x, float y0, float y1, float t){ box(x - t * 0.5f, y0 - t * 0.5f, x + t * 0.5f, y1 + t * 0.5f); }
+
+    void outline(const PitchRect& r, float t){
+        hline(r.left(), r.right(), r.top(), t);
+        hline(r.left(), r.right(), r.bottom(), t);
+        vline(r.left(), r.top(), r.bottom(), t);
+        vline(r.right(), r.top(), r.bottom(), t);
+    }
+
+    // Ring of thickness t; keep(x, y) selects which part of it is painted
+    template<class Keep>
+    void ring(float cx, float cy, float radius, float t, Keep keep){
+        cx *= s; cy *= s; radius *= s; t *= s;
+        const float outer = radius + t * 0.5f + 1.0f;
+        for(int y = (int)std::floor(cy - outer); y <= (int)std::ceil(cy + outer); ++y){
+            for(int x = (int)std::floor(cx - outer); x <= (int)std::ceil(cx + outer); ++x){
+                float px = x + 0.5f, py = y + 0.5f;
+                if(!keep(px / s, py / s)) continue;
+                float d = std::fabs(std::sqrt((px - cx) * (px - cx) + (py - cy) * (py - cy)) - radius);
+                cover(x, y, t * 0.5f + 0.5f - d);
+            }
+        }
+    }
+
+    void ring(float cx, float cy, float radius, float t){
+        ring(cx, cy, radius, t, [](float, float){ return true; });
+    }
+
+    void disc(float cx, float cy, float radius){
+        cx *= s; cy *= s; radius *= s;
+        for(int y = (int)std::floor(cy - radius - 1); y <= (int)std::ceil(cy + radius + 1); ++y){
+            for(int x = (int)std::floor(cx - radius - 1); x <= (int)std::ceil(cx + radius + 1); ++x){
+                float px = x + 0.5f, py = y + 0.5f;
+                cover(x, y, radius + 0.5f - std::sqrt((px - cx) * (px - cx) + (py - cy) * (py - cy)));
+            }
+        }
+    }
+
+    void markings(const PitchGeometry& g, float t){
+        const PitchRect& f = g.touchlines;
+        outline(f, t);
+        vline(g.centerSpot.x, f.top(), f.bottom(), t);
+        ring(g.centerSpot.x, g.centerSpot.y, g.centerCircleR, t);
+        disc(g.centerSpot.x, g.centerSpot.y, 4.0f);
+
+        for(int side = 0; side < 2; ++side){
+            const PitchRect& box = g.penaltyArea[side];
+            outline(box, t);
+            outline(g.goalArea[side], t);
+            disc(g.penaltySpot[side].x, g.penaltySpot[side].y, 3.5f);
+            // penalty arc: only the part outside the box
+            ring(g.penaltySpot[side].x, g.penaltySpot[side].y, g.penaltyArcR, t,
+                 [&](float x, float){ return side == 0 ? x > box.right() : x < box.left(); });
+        }
+
+        // corner arcs, inside the field
+        const float cr = 14.0f;
+        const PitchPoint corners[4] = { { f.left(), f.top() }, { f.right(), f.top() }, { f.left(), f.bottom() }, { f.right(), f.bottom() } };
+        for(const PitchPoint& c : corners) ring(c.x, c.y, cr, t, [&](float x, float y){ return f.contains(x, y); });
+    }
+};
+
+// Grass tiled from `sheet` plus markings from `g` scaled by `scale`,
+// ARGB8888, w x h. Caller frees the surface.
+inline SDL_Surface* build_pitch_surface(SDL_Surface* sheet, const SDL_Rect& tile, const PitchGeometry& g,
+                                        int w, int h, float scale = 1.0f,
+                                        SDL_Color lineColor = { 255, 255, 255, 230 }, float lineWidth = 3.0f){
+    SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if(!surf) return nullptr;
+
+    SDL_SetSurfaceBlendMode(sheet, SDL_BLENDMODE_NONE);
+    for(int y = 0; y < h; y += tile.h){
+        for(int x = 0; x < w; x += tile.w){
+            SDL_Rect src = tile, dst = { x, y, tile.w, tile.h };
+            SDL_BlitSurface(sheet, &src, surf, &dst);
+        }
+    }
+
+    PitchPainter paint(w, h, scale);
+    paint.markings(g, lineWidth);
+
+    SDL_LockSurface(surf);
+    for(int y = 0; y < h; ++y){
+        uint32_t* row = (uint32_t*)((uint8_t*)surf->pixels + (size_t)y * surf->pitch);
+        const uint8_t* m = &paint.mask[(size_t)y * w];
+        for(int x = 0; x < w; ++x){
+            if(!m[x]) continue;
+            uint32_t a = m[x] * lineColor.a / 255, inv = 255 - a, p = row[x];
+            uint32_t r = (((p >> 16) & 255) * inv + lineColor.r * a) / 255;
+            uint32_t gg = (((p >> 8) & 255) * inv + lineColor.g * a) / 255;
+            uint32_t b = ((p & 255) * inv + lineColor.b * a) / 255;
+            row[x] = 0xFF000000u | (r << 16) | (gg << 8) | b;
+        }
+    }
+    SDL_UnlockSurface(surf);
+    return surf;
+}
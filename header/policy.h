@@ -0,0 +1,353 @@
+// Small MLP policy evaluated in-process, batched over every agent that needs
+// a decision in the same call (all AI players of a match, or every match a
+// trainer is stepping). Hidden layers use ReLU, the last layer is linear.
+//
+// Two kernels: float, and int8 with weights quantized per output row and
+// activations per sample, products summed in int32 (_mm_madd_epi16). Both
+// are SSE2 with a scalar fallback; rows are zero-padded to 16 inputs so the
+// loops have no tails. Both kernels reuse each loaded weight row across
+// several samples (float: 2 rows x 4 samples, int8: 4 samples), which is
+// where batching pays off.
+//
+// File format (little-endian): "TFMLP1\0\0", uint32 layer count, then per
+// layer uint32 in, uint32 out, float weights[out][in], float bias[out].
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#include "rng.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TF_POLICY_SSE2 1
+#endif
+
+struct MlpLayer {
+    int in = 0, out = 0;
+    int inPad = 0;              // in rounded up to 16
+    std::vector<float> w;       // out x inPad, zero padded
+    std::vector<float> b;       // out
+    std::vector<int8_t> q;      // w quantized, out x inPad
+    std::vector<float> qScale;  // per row: w ~= q * qScale
+};
+
+namespace policy_detail {
+
+inline int pad16(int n){ return (n + 15) & ~15; }
+
+inline float dot(const float* w, const float* x, int n){
+#ifdef TF_POLICY_SSE2
+    __m128 acc = _mm_setzero_ps();
+    for(int i = 0; i < n; i += 4) acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(w + i), _mm_loadu_ps(x + i)));
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    return _mm_cvtss_f32(acc);
+#else
+    float acc = 0.0f;
+    for(int i = 0; i < n; ++i) acc += w[i] * x[i];
+    return acc;
+#endif
+}
+
+// One weight row against 4 samples (x0..x3 each n long)
+inline void dot4(const float* w, const float* x0, const float* x1, const float* x2, const float* x3, int n, float* out){
+#ifdef TF_POLICY_SSE2
+    __m128 a0 = _mm_setzero_ps(), a1 = a0, a2 = a0, a3 = a0;
+    for(int i = 0; i < n; i += 4){
+        __m128 wv = _mm_loadu_ps(w + i);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(wv, _mm_loadu_ps(x0 + i)));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(wv, _mm_loadu_ps(x1 + i)));
+        a2 = _mm_add_ps(a2, _mm_mul_ps(wv, _mm_loadu_ps(x2 + i)));
+        a3 = _mm_add_ps(a3, _mm_mul_ps(wv, _mm_loadu_ps(x3 + i)));
+    }
+    // transpose so lane k holds the sum for sample k
+    _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+    _mm_storeu_ps(out, _mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3)));
+#else
+    out[0] = dot(w, x0, n); out[1] = dot(w, x1, n);
+    out[2] = dot(w, x2, n); out[3] = dot(w, x3, n);
+#endif
+}
+
+// Two weight rows against 4 samples: 8 independent accumulators, each
+// weight load reused 4 times and each activation load twice
+inline void dot2x4(const float* w0, const float* w1, const float* x0, const float* x1, const float* x2, const float* x3,
+                   int n, float* out0, float* out1){
+#ifdef TF_POLICY_SSE2
+    __m128 a0 = _mm_setzero_ps(), a1 = a0, a2 = a0, a3 = a0;
+    __m128 b0 = a0, b1 = a0, b2 = a0, b3 = a0;
+    for(int i = 0; i < n; i += 4){
+        __m128 v0 = _mm_loadu_ps(w0 + i), v1 = _mm_loadu_ps(w1 + i);
+        __m128 s0 = _mm_loadu_ps(x0 + i), s1 = _mm_loadu_ps(x1 + i);
+        __m128 s2 = _mm_loadu_ps(x2 + i), s3 = _mm_loadu_ps(x3 + i);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(v0, s0)); b0 = _mm_add_ps(b0, _mm_mul_ps(v1, s0));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(v0, s1)); b1 = _mm_add_ps(b1, _mm_mul_ps(v1, s1));
+        a2 = _mm_add_ps(a2, _mm_mul_ps(v0, s2)); b2 = _mm_add_ps(b2, _mm_mul_ps(v1, s2));
+        a3 = _mm_add_ps(a3, _mm_mul_ps(v0, s3)); b3 = _mm_add_ps(b3, _mm_mul_ps(v1, s3));
+    }
+    _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+    _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+    _mm_storeu_ps(out0, _mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3)));
+    _mm_storeu_ps(out1, _mm_add_ps(_mm_add_ps(b0, b1), _mm_add_ps(b2, b3)));
+#else
+    dot4(w0, x0, x1, x2, x3, n, out0);
+    dot4(w1, x0, x1, x2, x3, n, out1);
+#endif
+}
+
+// int8 weights against int16 activations (values within int8 range)
+inline int32_t dot_i8(const int8_t* w, const int16_t* x, int n){
+#ifdef TF_POLICY_SSE2
+    __m128i acc = _mm_setzero_si128();
+    for(int i = 0; i < n; i += 16){
+        __m128i wv = _mm_loadu_si128((const __m128i*)(w + i));
+        __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(wv, wv), 8); // sign extend
+        __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(wv, wv), 8);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(lo, _mm_loadu_si128((const __m128i*)(x + i))));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(hi, _mm_loadu_si128((const __m128i*)(x + i + 8))));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(acc);
+#else
+    int32_t acc = 0;
+    for(int i = 0; i < n; ++i) acc += (int32_t)w[i] * x[i];
+    return acc;
+#endif
+}
+
+// One int8 weight row against 4 samples of int16 activations
+inline void dot4_i8(const int8_t* w, const int16_t* x0, const int16_t* x1, const int16_t* x2, const int16_t* x3,
+                    int n, int32_t* out){
+#ifdef TF_POLICY_SSE2
+    __m128i a0 = _mm_setzero_si128(), a1 = a0, a2 = a0, a3 = a0;
+    for(int i = 0; i < n; i += 16){
+        __m128i wv = _mm_loadu_si128((const __m128i*)(w + i));
+        __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(wv, wv), 8);
+        __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(wv, wv), 8);
+        a0 = _mm_add_epi32(a0, _mm_add_epi32(_mm_madd_epi16(lo, _mm_loadu_si128((const __m128i*)(x0 + i))),
+                                             _mm_madd_epi16(hi, _mm_loadu_si128((const __m128i*)(x0 + i + 8)))));
+        a1 = _mm_add_epi32(a1, _mm_add_epi32(_mm_madd_epi16(lo, _mm_loadu_si128((const __m128i*)(x1 + i))),
+                                             _mm_madd_epi16(hi, _mm_loadu_si128((const __m128i*)(x1 + i + 8)))));
+        a2 = _mm_add_epi32(a2, _mm_add_epi32(_mm_madd_epi16(lo, _mm_loadu_si128((const __m128i*)(x2 + i))),
+                                             _mm_madd_epi16(hi, _mm_loadu_si128((const __m128i*)(x2 + i + 8)))));
+        a3 = _mm_add_epi32(a3, _mm_add_epi32(_mm_madd_epi16(lo, _mm_loadu_si128((const __m128i*)(x3 + i))),
+                                             _mm_madd_epi16(hi, _mm_loadu_si128((const __m128i*)(x3 + i + 8)))));
+    }
+    // 4x4 transpose then add: lane k = sum for sample k
+    __m128i t0 = _mm_unpacklo_epi32(a0, a1), t1 = _mm_unpackhi_epi32(a0, a1);
+    __m128i t2 = _mm_unpacklo_epi32(a2, a3), t3 = _mm_unpackhi_epi32(a2, a3);
+    __m128i s = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi64(t0, t2), _mm_unpackhi_epi64(t0, t2)),
+                              _mm_add_epi32(_mm_unpacklo_epi64(t1, t3), _mm_unpackhi_epi64(t1, t3)));
+    _mm_storeu_si128((__m128i*)out, s);
+#else
+    out[0] = dot_i8(w, x0, n); out[1] = dot_i8(w, x1, n);
+    out[2] = dot_i8(w, x2, n); out[3] = dot_i8(w, x3, n);
+#endif
+}
+
+// Round row[0..n) * inv to int16 (|values| <= 127 after scaling)
+inline void quantize_row(const float* row, int n, float inv, int16_t* out){
+    int i = 0;
+#ifdef TF_POLICY_SSE2
+    __m128 k = _mm_set1_ps(inv);
+    for(; i + 8 <= n; i += 8){
+        __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(row + i), k));
+        __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(row + i + 4), k));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for(; i < n; ++i) out[i] = (int16_t)std::lrint(row[i] * inv);
+}
+
+} // namespace policy_detail
+
+struct MlpPolicy {
+    static constexpr char MAGIC[8] = { 'T', 'F', 'M', 'L', 'P', '1', 0, 0 };
+    static constexpr int MAX_LAYERS = 16;
+    static constexpr int MAX_WIDTH = 4096;
+
+    std::vector<MlpLayer> layers;
+    bool int8 = false; // use the quantized kernel
+
+    int inputs()  const { return layers.empty() ? 0 : layers.front().in; }
+    int outputs() const { return layers.empty() ? 0 : layers.back().out; }
+
+    // He-uniform weights, zero bias: for smoke tests and benchmarks
+    static MlpPolicy random(std::initializer_list<int> sizes, uint64_t seed){
+        MlpPolicy p;
+        Pcg32 rng(seed, 7);
+        const int* s = sizes.begin();
+        for(size_t l = 0; l + 1 < sizes.size(); ++l){
+            MlpLayer& L = p.add_layer(s[l], s[l + 1]);
+            float limit = std::sqrt(6.0f / (float)L.in);
+            for(int o = 0; o < L.out; ++o)
+                for(int i = 0; i < L.in; ++i) L.w[(size_t)o * L.inPad + i] = rng.range(-limit, limit);
+        }
+        p.quantize();
+        return p;
+    }
+
+    bool load(const char* path){
+        FILE* f = fopen(path, "rb");
+        if(!f) return false;
+        char magic[8];
+        uint32_t count = 0;
+        bool ok = fread(magic, 1, 8, f) == 8 && memcmp(magic, MAGIC, 8) == 0 &&
+                  fread(&count, 4, 1, f) == 1 && count > 0 && count <= MAX_LAYERS;
+        layers.clear();
+        for(uint32_t l = 0; ok && l < count; ++l){
+            uint32_t in = 0, out = 0;
+            ok = fread(&in, 4, 1, f) == 1 && fread(&out, 4, 1, f) == 1 &&
+                 in > 0 && out > 0 && in <= MAX_WIDTH && out <= MAX_WIDTH &&
+                 (layers.empty() || (int)in == layers.back().out);
+            if(!ok) break;
+            MlpLayer& L = add_layer((int)in, (int)out);
+            for(int o = 0; ok && o < L.out; ++o) ok = fread(&L.w[(size_t)o * L.inPad], 4, in, f) == in;
+            ok = ok && fread(L.b.data(), 4, out, f) == out;
+        }
+        fclose(f);
+        if(!ok){ layers.clear(); return false; }
+        quantize();
+        return true;
+    }
+
+    bool save(const char* path) const {
+        FILE* f = fopen(path, "wb");
+        if(!f) return false;
+        uint32_t count = (uint32_t)layers.size();
+        bool ok = fwrite(MAGIC, 1, 8, f) == 8 && fwrite(&count, 4, 1, f) == 1;
+        for(const MlpLayer& L : layers){
+            uint32_t in = (uint32_t)L.in, out = (uint32_t)L.out;
+            ok = ok && fwrite(&in, 4, 1, f) == 1 && fwrite(&out, 4, 1, f) == 1;
+            for(int o = 0; ok && o < L.out; ++o) ok = fwrite(&L.w[(size_t)o * L.inPad], 4, in, f) == in;
+            ok = ok && fwrite(L.b.data(), 4, out, f) == out;
+        }
+        return fclose(f) == 0 && ok;
+    }
+
+    // Symmetric per-row int8 copy of the float weights
+    void quantize(){
+        for(MlpLayer& L : layers){
+            L.q.assign(L.w.size(), 0);
+            L.qScale.assign(L.out, 0.0f);
+            for(int o = 0; o < L.out; ++o){
+                const float* w = &L.w[(size_t)o * L.inPad];
+                float maxAbs = 0.0f;
+                for(int i = 0; i < L.in; ++i) maxAbs = std::max(maxAbs, std::fabs(w[i]));
+                float scale = maxAbs > 0.0f ? maxAbs / 127.0f : 1.0f;
+                L.qScale[o] = scale;
+                for(int i = 0; i < L.in; ++i) L.q[(size_t)o * L.inPad + i] = (int8_t)std::lrint(w[i] / scale);
+            }
+        }
+    }
+
+    // in: batch rows of inputs() floats, out: batch rows of outputs() floats.
+    // Scratch is per thread, so one policy can serve several threads.
+    void forward(const float* in, int batch, float* out) const {
+        if(layers.empty() || batch <= 0) return;
+        thread_local std::vector<float> bufA, bufB;
+        thread_local std::vector<int16_t> xq;
+        thread_local std::vector<float> xScale;
+
+        int stride = layers.front().inPad;
+        bufA.assign((size_t)batch * stride, 0.0f);
+        for(int s = 0; s < batch; ++s) memcpy(&bufA[(size_t)s * stride], in + (size_t)s * inputs(), sizeof(float) * inputs());
+
+        std::vector<float>* cur = &bufA;
+        std::vector<float>* next = &bufB;
+        for(size_t l = 0; l < layers.size(); ++l){
+            const MlpLayer& L = layers[l];
+            bool last = l + 1 == layers.size();
+            int outStride = last ? L.out : policy_detail::pad16(L.out);
+            float* dst = out;
+            if(!last){
+                next->assign((size_t)batch * outStride, 0.0f);
+                dst = next->data();
+            }
+            if(int8) layer_int8(L, cur->data(), batch, dst, outStride, xq, xScale);
+            else layer_float(L, cur->data(), batch, dst, outStride);
+            if(!last){
+                for(int s = 0; s < batch; ++s){
+                    float* row = dst + (size_t)s * outStride;
+                    for(int o = 0; o < L.out; ++o) row[o] = std::max(row[o], 0.0f); // ReLU
+                }
+                std::swap(cur, next);
+            }
+        }
+    }
+
+private:
+    MlpLayer& add_layer(int in, int out){
+        MlpLayer& L = layers.emplace_back();
+        L.in = in; L.out = out;
+        L.inPad = policy_detail::pad16(in);
+        L.w.assign((size_t)out * L.inPad, 0.0f);
+        L.b.assign(out, 0.0f);
+        return L;
+    }
+
+    static void layer_float(const MlpLayer& L, const float* x, int batch, float* dst, int outStride){
+        const int n = L.inPad;
+        int s = 0;
+        for(; s + 4 <= batch; s += 4){
+            const float* x0 = x + (size_t)s * n;
+            int o = 0;
+            for(; o + 2 <= L.out; o += 2){
+                float r0[4], r1[4];
+                policy_detail::dot2x4(&L.w[(size_t)o * n], &L.w[(size_t)(o + 1) * n], x0, x0 + n, x0 + 2 * n, x0 + 3 * n, n, r0, r1);
+                for(int k = 0; k < 4; ++k){
+                    dst[(size_t)(s + k) * outStride + o]     = r0[k] + L.b[o];
+                    dst[(size_t)(s + k) * outStride + o + 1] = r1[k] + L.b[o + 1];
+                }
+            }
+            for(; o < L.out; ++o){
+                float r[4];
+                policy_detail::dot4(&L.w[(size_t)o * n], x0, x0 + n, x0 + 2 * n, x0 + 3 * n, n, r);
+                for(int k = 0; k < 4; ++k) dst[(size_t)(s + k) * outStride + o] = r[k] + L.b[o];
+            }
+        }
+        for(; s < batch; ++s){
+            for(int o = 0; o < L.out; ++o)
+                dst[(size_t)s * outStride + o] = policy_detail::dot(&L.w[(size_t)o * n], x + (size_t)s * n, n) + L.b[o];
+        }
+    }
+
+    static void layer_int8(const MlpLayer& L, const float* x, int batch, float* dst, int outStride,
+                           std::vector<int16_t>& xq, std::vector<float>& xScale){
+        const int n = L.inPad;
+        xq.assign((size_t)batch * n, 0);
+        xScale.assign(batch, 0.0f);
+        for(int s = 0; s < batch; ++s){
+            const float* row = x + (size_t)s * n;
+            float maxAbs = 0.0f;
+            for(int i = 0; i < L.in; ++i) maxAbs = std::max(maxAbs, std::fabs(row[i]));
+            float scale = maxAbs > 0.0f ? maxAbs / 127.0f : 1.0f;
+            xScale[s] = scale;
+            policy_detail::quantize_row(row, L.in, 1.0f / scale, &xq[(size_t)s * n]);
+        }
+        int s = 0;
+        for(; s + 4 <= batch; s += 4){
+            const int16_t* x0 = &xq[(size_t)s * n];
+            for(int o = 0; o < L.out; ++o){
+                int32_t acc[4];
+                policy_detail::dot4_i8(&L.q[(size_t)o * n], x0, x0 + n, x0 + 2 * n, x0 + 3 * n, n, acc);
+                for(int k = 0; k < 4; ++k)
+                    dst[(size_t)(s + k) * outStride + o] = (float)acc[k] * L.qScale[o] * xScale[s + k] + L.b[o];
+            }
+        }
+        for(; s < batch; ++s){
+            const int16_t* xs = &xq[(size_t)s * n];
+            for(int o = 0; o < L.out; ++o){
+                int32_t acc = policy_detail::dot_i8(&L.q[(size_t)o * n], xs, n);
+                dst[(size_t)s * outStride + o] = (float)acc * L.qScale[o] * xScale[s] + L.b[o];
+            }
+        }
+    }
+};
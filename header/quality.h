@@ -0,0 +1,93 @@
+// Adaptive quality: steps optional work down when frames miss the budget
+// and back up when there is headroom again.
+//
+// Two signals, both smoothed: the interval between consecutive presented
+// frames (catches missed vsyncs, whatever the cause) and the CPU work per
+// frame excluding the wait in present (the only way to see headroom while
+// vsync pins the interval at the budget). Hysteresis comes from separate
+// degrade / restore thresholds, a dwell time for each, a minimum hold after
+// every change and a restore delay that doubles when a restore is undone
+// soon after.
+#pragma once
+
+#include <algorithm>
+
+struct QualitySettings {
+    const char* name;
+    bool debugOverlays;   // F3-F6 geometry and debug trails
+    float aiReplanStretch; // x the AI re-plan period (never below 1: staggering stays on)
+    float particleScale;  // x ParticlePool::DEFAULT_BUDGET spawns per frame
+    int limbDetail;       // 2 arms + legs, 1 legs only, 0 body only
+    bool shadows;
+};
+
+// Lowest first; the governor walks this table
+inline constexpr QualitySettings QUALITY_LEVELS[] = {
+    { "minimal", false, 3.0f, 0.10f, 0, false },
+    { "low",     false, 2.0f, 0.25f, 1, false },
+    { "medium",  false, 1.5f, 0.50f, 2, true  },
+    { "high",    false, 1.0f, 1.00f, 2, true  },
+    { "full",    true,  1.0f, 1.00f, 2, true  },
+};
+constexpr int QUALITY_LEVEL_COUNT = (int)(sizeof(QUALITY_LEVELS) / sizeof(QUALITY_LEVELS[0]));
+
+struct QualityGovernor {
+    static constexpr float SMOOTHING     = 0.1f;  // EWMA weight of a new sample
+    static constexpr float OVER_INTERVAL = 1.15f; // interval > budget * this = missed frames
+    static constexpr float WORK_HIGH     = 0.90f; // work > budget * this = about to miss
+    static constexpr float WORK_LOW      = 0.55f; // work < budget * this = room for more
+    static constexpr float DEGRADE_AFTER = 0.25f; // seconds over before stepping down
+    static constexpr float RESTORE_AFTER = 3.0f;  // seconds under before stepping up
+    static constexpr float MIN_HOLD      = 1.0f;  // seconds after any change
+    static constexpr float MAX_RESTORE   = 30.0f;
+
+    float budget = 1.0f / 60.0f;
+    bool automatic = true;           // false: level fixed by --quality
+    int level = QUALITY_LEVEL_COUNT - 1;
+
+    float interval = 0.0f, work = 0.0f;  // smoothed seconds
+    float overFor = 0.0f, underFor = 0.0f, sinceChange = 0.0f;
+    float restoreAfter = RESTORE_AFTER;
+    bool lastWasRestore = false;
+    int changes = 0;
+
+    const QualitySettings& settings() const { return QUALITY_LEVELS[level]; }
+
+    // One presented frame: seconds since the previous one, CPU seconds spent on it.
+    // Returns true when the level changed.
+    bool observe(float frameInterval, float frameWork){
+        if(!automatic || frameInterval <= 0.0f) return false;
+        if(interval == 0.0f){ interval = frameInterval; work = frameWork; }
+        interval += (frameInterval - interval) * SMOOTHING;
+        work += (frameWork - work) * SMOOTHING;
+        sinceChange += frameInterval;
+
+        bool over = interval > budget * OVER_INTERVAL || work > budget * WORK_HIGH;
+        bool under = !over && work < budget * WORK_LOW;
+        overFor = over ? overFor + frameInterval : 0.0f;
+        underFor = under ? underFor + frameInterval : 0.0f;
+        if(sinceChange < MIN_HOLD) return false;
+
+        if(overFor >= DEGRADE_AFTER && level > 0){
+            // a restore that did not hold: wait longer before trying again
+            if(lastWasRestore && sinceChange < restoreAfter) restoreAfter = std::min(restoreAfter * 2.0f, MAX_RESTORE);
+            return step(-1);
+        }
+        if(underFor >= restoreAfter && level < QUALITY_LEVEL_COUNT - 1) return step(+1);
+        return false;
+    }
+
+    void set_fixed(int fixedLevel){
+        automatic = false;
+        level = std::clamp(fixedLevel, 0, QUALITY_LEVEL_COUNT - 1);
+    }
+
+private:
+    bool step(int dir){
+        level += dir;
+        lastWasRestore = dir > 0;
+        overFor = underFor = sinceChange = 0.0f;
+        ++changes;
+        return true;
+    }
+};
@@ -0,0 +1,103 @@
+// Match replays: timestamped snapshots of everything the world layer draws
+// (ball, players, score), recorded at a fixed rate while playing. Every
+// snapshot is a keyframe, so any output frame can be rebuilt on its own by
+// interpolating the two keyframes around its timestamp; the exporter relies
+// on that to render frames in parallel.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+struct ReplayPlayer {
+    float x, y;          // visual position (Player::visX/visY)
+    float moveX, moveY;
+    float animTime;
+    uint8_t active;
+};
+
+struct ReplayFrame {
+    static constexpr int MAX_PLAYERS = 8;
+
+    float time;          // seconds since the start of the recording
+    float ballX, ballY, ballAngle;
+    uint8_t scoreLeft, scoreRight;
+    uint8_t playerCount;
+    ReplayPlayer players[MAX_PLAYERS];
+};
+
+struct Replay {
+    static constexpr uint32_t VERSION = 1;
+    static constexpr float RECORD_HZ = 60.0f;
+
+    uint64_t seed = 0;
+    std::vector<ReplayFrame> frames;
+
+    float duration() const { return frames.empty() ? 0.0f : frames.back().time; }
+
+    // Keyframes around t, linearly blended (discrete fields from the earlier one)
+    ReplayFrame sample(float t) const {
+        if(frames.empty()) return ReplayFrame{};
+        if(t <= frames.front().time) return frames.front();
+        if(t >= frames.back().time) return frames.back();
+        auto it = std::upper_bound(frames.begin(), frames.end(), t,
+                                   [](float v, const ReplayFrame& f){ return v < f.time; });
+        const ReplayFrame& b = *it;
+        const ReplayFrame& a = *(it - 1);
+        float span = b.time - a.time;
+        float k = span > 0.0f ? (t - a.time) / span : 0.0f;
+        auto lerp = [k](float u, float v){ return u + (v - u) * k; };
+
+        ReplayFrame f = a;
+        f.time = t;
+        f.ballX = lerp(a.ballX, b.ballX);
+        f.ballY = lerp(a.ballY, b.ballY);
+        float da = b.ballAngle - a.ballAngle;  // shortest way round
+        if(da > 180.0f) da -= 360.0f;
+        if(da < -180.0f) da += 360.0f;
+        f.ballAngle = a.ballAngle + da * k;
+        for(int i = 0; i < f.playerCount && i < b.playerCount; ++i){
+            f.players[i].x        = lerp(a.players[i].x, b.players[i].x);
+            f.players[i].y        = lerp(a.players[i].y, b.players[i].y);
+            f.players[i].moveX    = lerp(a.players[i].moveX, b.players[i].moveX);
+            f.players[i].moveY    = lerp(a.players[i].moveY, b.players[i].moveY);
+            f.players[i].animTime = lerp(a.players[i].animTime, b.players[i].animTime);
+        }
+        return f;
+    }
+
+    // File: "TFRP", version, seed, frame count, frame size, raw frames
+    bool save(const char* path) const {
+        FILE* f = fopen(path, "wb");
+        if(!f) return false;
+        uint32_t count = (uint32_t)frames.size(), frameSize = sizeof(ReplayFrame);
+        bool ok = fwrite("TFRP", 1, 4, f) == 4
+               && fwrite(&VERSION, sizeof(VERSION), 1, f) == 1
+               && fwrite(&seed, sizeof(seed), 1, f) == 1
+               && fwrite(&count, sizeof(count), 1, f) == 1
+               && fwrite(&frameSize, sizeof(frameSize), 1, f) == 1
+               && fwrite(frames.data(), sizeof(ReplayFrame), count, f) == count;
+        return fclose(f) == 0 && ok;
+    }
+
+    bool load(const char* path){
+        FILE* f = fopen(path, "rb");
+        if(!f) return false;
+        char magic[4];
+        uint32_t version = 0, count = 0, frameSize = 0;
+        bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, "TFRP", 4) == 0
+               && fread(&version, sizeof(version), 1, f) == 1 && version == VERSION
+               && fread(&seed, sizeof(seed), 1, f) == 1
+               && fread(&count, sizeof(count), 1, f) == 1
+               && fread(&frameSize, sizeof(frameSize), 1, f) == 1 && frameSize == sizeof(ReplayFrame);
+        if(ok){
+            frames.resize(count);
+            ok = fread(frames.data(), sizeof(ReplayFrame), count, f) == count;
+        }
+        fclose(f);
+        if(!ok) frames.clear();
+        return ok;
+    }
+};
@@ -0,0 +1,76 @@
+// Per-match random numbers: PCG32 (O'Neill, pcg-random.org).
+// 16 bytes of state, owned by the match, seeded explicitly. Two generators
+// with the same seed and different stream ids never overlap, and advance()
+// jumps ahead in O(log n), so parallel matches are independent and each
+// run can be reproduced from (seed, stream).
+#pragma once
+
+#include <cstdint>
+
+struct Pcg32 {
+    static constexpr uint64_t MULT = 6364136223846793005ULL;
+
+    uint64_t state = 0x853c49e6748fea9bULL;
+    uint64_t inc   = 0xda3e39cb94b95bdbULL; // stream selector, always odd
+
+    constexpr Pcg32() = default;
+    constexpr Pcg32(uint64_t seedValue, uint64_t stream = 0){ seed(seedValue, stream); }
+
+    constexpr void seed(uint64_t seedValue, uint64_t stream = 0){
+        state = 0;
+        inc = (stream << 1u) | 1u;
+        next();
+        state += seedValue;
+        next();
+    }
+
+    constexpr uint32_t next(){
+        uint64_t old = state;
+        state = old * MULT + inc;
+        uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = (uint32_t)(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+    }
+
+    // [0, 1)
+    constexpr float next_float(){ return (next() >> 8) * (1.0f / 16777216.0f); }
+    // [a, b)
+    constexpr float range(float a, float b){ return a + (b - a) * next_float(); }
+
+    // Uniform integer in [0, bound) without modulo bias
+    constexpr uint32_t bounded(uint32_t bound){
+        uint32_t threshold = (0u - bound) % bound;
+        for(;;){
+            uint32_t r = next();
+            if(r >= threshold) return r % bound;
+        }
+    }
+
+    // Skip delta outputs in O(log delta)
+    constexpr void advance(uint64_t delta){
+        uint64_t accMult = 1, accPlus = 0;
+        uint64_t curMult = MULT, curPlus = inc;
+        while(delta > 0){
+            if(delta & 1u){
+                accMult *= curMult;
+                accPlus = accPlus * curMult + curPlus;
+            }
+            curPlus = (curMult + 1) * curPlus;
+            curMult *= curMult;
+            delta >>= 1u;
+        }
+        state = accMult * state + accPlus;
+    }
+
+    // Independent generator for sub-system / match `id` derived from one seed
+    static constexpr Pcg32 stream(uint64_t seedValue, uint64_t id){ return Pcg32(seedValue, id); }
+};
+
+constexpr bool pcg_advance_matches_stepping(){
+    Pcg32 a(42, 7), b(42, 7);
+    for(int i = 0; i < 1000; ++i) a.next();
+    b.advance(1000);
+    return a.state == b.state && a.next() == b.next();
+}
+static_assert(pcg_advance_matches_stepping(), "Pcg32::advance must equal stepping");
+static_assert(Pcg32(1, 0).next() != Pcg32(1, 1).next(), "streams must differ");
@@ -0,0 +1,141 @@
+// Scripted scenarios: a C++20 coroutine sets up a match, holds keys over a
+// number of ticks and checks what happened. The runner owns the clock: it
+// steps the simulation one fixed tick at a time and resumes the script once
+// its wait is over, so a scenario is deterministic and runs as fast as the
+// simulation itself (regression check and physics benchmark in one).
+//
+// Coroutine frames come from a ScenarioArena (bump allocator over a fixed
+// buffer, rewound when the last frame dies) instead of the heap.
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <utility>
+
+struct ScenarioArena {
+    static constexpr size_t SIZE = 16 * 1024;
+
+    alignas(std::max_align_t) unsigned char buf[SIZE];
+    size_t used = 0, peak = 0;
+    int live = 0;
+
+    void* allocate(size_t n){
+        n = (n + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        if(used + n > SIZE) return nullptr;
+        void* p = buf + used;
+        used += n;
+        peak = std::max(peak, used);
+        ++live;
+        return p;
+    }
+    void release(){ if(--live == 0) used = 0; }
+
+    // Arena used by coroutine frames created on this thread
+    static ScenarioArena*& current(){
+        thread_local ScenarioArena* arena = nullptr;
+        return arena;
+    }
+};
+
+// What a script sees: keys it holds down, the tick counter and its checks
+struct ScenarioContext {
+    Uint8 keys[SDL_NUM_SCANCODES] = {};
+    int tick = 0;
+    int checks = 0, failures = 0;
+    char firstFailure[160] = "";
+
+    // Runner state: ticks left to wait, optional early-wake test
+    int wait = 0;
+    bool (*test)(void*) = nullptr;
+    void* testArg = nullptr;
+
+    void hold(SDL_Scancode key, bool down = true){ keys[key] = down ? 1 : 0; }
+    void release_all(){ memset(keys, 0, sizeof(keys)); }
+
+    bool check(bool ok, const char* what){
+        ++checks;
+        if(!ok && failures++ == 0) snprintf(firstFailure, sizeof(firstFailure), "tick %d: %s", tick, what);
+        return ok;
+    }
+
+    // co_await sc.ticks(n): let the simulation run n ticks
+    struct TickWait {
+        ScenarioContext& sc;
+        int n;
+        bool await_ready() const { return n <= 0; }
+        void await_suspend(std::coroutine_handle<>){ sc.wait = n; sc.test = nullptr; }
+        void await_resume() const {}
+    };
+    TickWait ticks(int n){ return { *this, n }; }
+
+    // co_await sc.until(pred, limit): run until pred() holds, at most limit
+    // ticks; true if it held. pred is checked after every tick.
+    template<class Pred>
+    struct UntilWait {
+        ScenarioContext& sc;
+        Pred pred;
+        int limit;
+        bool met = false;
+        bool await_ready(){ return met = pred(); }
+        void await_suspend(std::coroutine_handle<>){
+            sc.wait = limit;
+            sc.test = [](void* self){ UntilWait* w = (UntilWait*)self; return w->met = w->pred(); };
+            sc.testArg = this;
+        }
+        bool await_resume() const { return met; }
+    };
+    template<class Pred>
+    UntilWait<Pred> until(Pred pred, int limit){ return { *this, std::move(pred), limit }; }
+};
+
+struct ScenarioTask {
+    struct promise_type {
+        static void* operator new(size_t n) noexcept {
+            ScenarioArena* arena = ScenarioArena::current();
+            return arena ? arena->allocate(n) : nullptr;
+        }
+        static void operator delete(void*, size_t){ ScenarioArena::current()->release(); }
+        static ScenarioTask get_return_object_on_allocation_failure(){ return {}; }
+
+        ScenarioTask get_return_object(){ return ScenarioTask{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void(){}
+        void unhandled_exception(){ std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+
+    ScenarioTask() = default;
+    explicit ScenarioTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+    ScenarioTask(ScenarioTask&& o) noexcept : handle(std::exchange(o.handle, {})) {}
+    ScenarioTask& operator=(ScenarioTask&&) = delete;
+    ~ScenarioTask(){ if(handle) handle.destroy(); }
+
+    explicit operator bool() const { return (bool)handle; }
+};
+
+// Runs the script to completion: step(keys) advances the simulation one tick.
+// Returns false (and records a failure) if it is still waiting after maxTicks.
+template<class Step>
+bool run_scenario(ScenarioTask& task, ScenarioContext& sc, Step&& step, int maxTicks){
+    if(!task){ sc.check(false, "coroutine frame did not fit the arena"); return false; }
+    task.handle.resume();
+    while(!task.handle.done()){
+        if(sc.tick >= maxTicks){ sc.check(false, "scenario timed out"); return false; }
+        step((const Uint8*)sc.keys);
+        ++sc.tick;
+        bool ready = --sc.wait <= 0;
+        if(sc.test && sc.test(sc.testArg)) ready = true;
+        if(ready){
+            sc.test = nullptr;
+            task.handle.resume();
+        }
+    }
+    return sc.failures == 0;
+}
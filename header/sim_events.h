@@ -0,0 +1,37 @@
+// Simulation events: what happened during a frame (kicks, bounces, goals).
+// Producers push into a fixed-size queue, consumers (effects, sound, AI...)
+// read it after Game::update; the queue is cleared at the start of each frame.
+#pragma once
+
+#include <cstdint>
+
+enum class SimEventType : uint8_t {
+    Kick,          // player kicked the ball
+    WallBounce,    // ball bounced off a wall
+    PlayerBounce,  // ball bounced off a player
+    Goal,          // ball crossed a goal line between the posts
+};
+
+struct SimEvent {
+    SimEventType type;
+    float x, y;     // where it happened (ball centre)
+    float dx, dy;   // direction: kick/bounce normal, or into the goal
+    int   team;     // team involved (kicker / scorer), -1 if none
+};
+
+struct SimEventQueue {
+    static constexpr int CAPACITY = 64;
+
+    SimEvent items[CAPACITY];
+    int count = 0;
+    int dropped = 0; // events lost this frame because the queue was full
+
+    void push(SimEventType type, float x, float y, float dx, float dy, int team = -1){
+        if(count >= CAPACITY){ ++dropped; return; }
+        items[count++] = { type, x, y, dx, dy, team };
+    }
+    void clear(){ count = 0; dropped = 0; }
+
+    const SimEvent* begin() const { return items; }
+    const SimEvent* end()   const { return items + count; }
+};
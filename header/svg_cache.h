@@ -0,0 +1,115 @@
+// SVG art rasterized at the exact size it is drawn at, cached on disk.
+// The first launch at a given resolution pays for the rasterization
+// (IMG_LoadSizedSVG_RW, SDL_image 2.6+); later launches load a BMP, which is
+// a straight copy. Cache files are named after the SVG, the output size and
+// an FNV-1a hash of the SVG bytes, so editing an SVG or changing resolution
+// simply misses the cache. Older SDL_image has no sized SVG loader:
+// rasterize() then always returns nullptr and callers use the PNG art.
+#pragma once
+
+#include <SDL.h>
+#include <SDL_image.h>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "hash.h"
+#include "log.h"
+
+#ifdef SDL_IMAGE_VERSION_ATLEAST
+#if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+#define TF_SVG_RASTER 1
+#endif
+#endif
+
+struct SvgCache {
+    static constexpr uint32_t FORMAT = 1; // bump when the cached pixels change meaning
+#ifdef TF_SVG_RASTER
+    static constexpr bool SUPPORTED = true;
+#else
+    static constexpr bool SUPPORTED = false;
+#endif
+
+    std::string dir = "svg_cache";
+    int hits = 0, misses = 0;
+
+    // svgPath rasterized at w x h (stretched like preserveAspectRatio="none"),
+    // optionally cropped to `crop`. ARGB8888, caller frees; nullptr if the
+    // SVG is missing or SDL_image was built without SVG support.
+    SDL_Surface* rasterize(const char* svgPath, int w, int h, const SDL_Rect* crop = nullptr){
+        if(!SUPPORTED) return nullptr;
+        std::vector<char> svg;
+        if(!read_file(svgPath, svg) || w <= 0 || h <= 0) return nullptr;
+
+        Fnv1a key;
+        key.add(FORMAT);
+        key.add(svg.data(), svg.size());
+        key.add(w); key.add(h);
+        if(crop) key.add(*crop);
+        std::string path = cache_path(svgPath, crop ? crop->w : w, crop ? crop->h : h, key.value());
+
+        if(SDL_Surface* cached = SDL_LoadBMP(path.c_str())){
+            SDL_Surface* surf = SDL_ConvertSurfaceFormat(cached, SDL_PIXELFORMAT_ARGB8888, 0);
+            SDL_FreeSurface(cached);
+            if(surf){ ++hits; return surf; }
+        }
+
+#ifdef TF_SVG_RASTER
+        SDL_RWops* rw = SDL_RWFromConstMem(svg.data(), (int)svg.size());
+        SDL_Surface* raster = rw ? IMG_LoadSizedSVG_RW(rw, w, h) : nullptr;
+        if(rw) SDL_RWclose(rw);
+#else
+        SDL_Surface* raster = nullptr;
+#endif
+        if(!raster) return nullptr;
+        SDL_Surface* surf = crop ? copy_rect(raster, *crop) : SDL_ConvertSurfaceFormat(raster, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(raster);
+        if(!surf) return nullptr;
+        ++misses;
+        store(surf, path);
+        return surf;
+    }
+
+private:
+    static bool read_file(const char* path, std::vector<char>& out){
+        FILE* f = fopen(path, "rb");
+        if(!f) return false;
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        out.resize(size > 0 ? (size_t)size : 0);
+        bool ok = size > 0 && fread(out.data(), 1, out.size(), f) == out.size();
+        fclose(f);
+        return ok;
+    }
+
+    std::string cache_path(const char* svgPath, int w, int h, uint64_t hash) const {
+        char name[96];
+        snprintf(name, sizeof(name), "_%dx%d_%016llx.bmp", w, h, (unsigned long long)hash);
+        return dir + "/" + std::filesystem::path(svgPath).stem().string() + name;
+    }
+
+    static SDL_Surface* copy_rect(SDL_Surface* src, const SDL_Rect& r){
+        SDL_Surface* out = SDL_CreateRGBSurfaceWithFormat(0, r.w, r.h, 32, SDL_PIXELFORMAT_ARGB8888);
+        if(!out) return nullptr;
+        SDL_Rect s = r;
+        SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE); // giữ nguyên alpha
+        SDL_BlitSurface(src, &s, out, nullptr);
+        return out;
+    }
+
+    // Write to a temp name then rename, so a second instance never reads half a file
+    void store(SDL_Surface* surf, const std::string& path) const {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        std::string tmp = path + ".tmp";
+        if(SDL_SaveBMP(surf, tmp.c_str()) != 0){
+            LOG_WARN("Could not write SVG cache %s (%s)", path, SDL_GetError());
+            return;
+        }
+        std::filesystem::rename(tmp, path, ec);
+        if(ec) std::filesystem::remove(tmp, ec);
+    }
+};
@@ -0,0 +1,94 @@
+// Small persistent worker pool with a blocking parallel_for.
+// The calling thread takes part in the work, so a pool of size() threads
+// has size() - 1 workers. One parallel_for at a time per pool.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ThreadPool {
+    // threads = 0: one per hardware thread
+    explicit ThreadPool(int threads = 0){
+        if(threads <= 0) threads = (int)std::thread::hardware_concurrency();
+        if(threads <= 0) threads = 1;
+        for(int i = 1; i < threads; ++i) workers.emplace_back([this]{ worker_loop(); });
+    }
+
+    ~ThreadPool(){
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stop = true;
+        }
+        cv.notify_all();
+        for(auto &t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int)workers.size() + 1; }
+
+    // Run fn(0..n-1) across the pool, returns when every index is done
+    void parallel_for(int n, const std::function<void(int)>& fn){
+        if(n <= 0) return;
+        if(workers.empty() || n == 1){
+            for(int i = 0; i < n; ++i) fn(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lk(m);
+            job = &fn;
+            jobCount = n;
+            next.store(0);
+            pending = (int)workers.size();
+            ++generation;
+        }
+        cv.notify_all();
+        run_job(fn, n);
+
+        std::unique_lock<std::mutex> lk(m);
+        doneCv.wait(lk, [this]{ return pending == 0; });
+        job = nullptr;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable cv, doneCv;
+    const std::function<void(int)>* job = nullptr;
+    int jobCount = 0;
+    int pending = 0;
+    uint64_t generation = 0;
+    bool stop = false;
+    std::atomic<int> next{0};
+
+    void run_job(const std::function<void(int)>& fn, int n){
+        for(;;){
+            int i = next.fetch_add(1, std::memory_order_relaxed);
+            if(i >= n) break;
+            fn(i);
+        }
+    }
+
+    void worker_loop(){
+        uint64_t seen = 0;
+        for(;;){
+            std::unique_lock<std::mutex> lk(m);
+            cv.wait(lk, [&]{ return stop || generation != seen; });
+            if(stop) return;
+            seen = generation;
+            const std::function<void(int)>* fn = job;
+            int n = jobCount;
+            lk.unlock();
+
+            run_job(*fn, n);
+
+            lk.lock();
+            if(--pending == 0) doneCv.notify_one();
+        }
+    }
+};
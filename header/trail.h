@@ -0,0 +1,73 @@
+// Motion trails: fixed-size ring buffer of past positions drawn as one
+// tapered quad strip (single geometry call). No allocation after
+// construction; every sample is one simulation tick, so gaps in the strip
+// show how far the entity jumped per frame (tunneling / jitter at low fps).
+#pragma once
+
+#include <SDL.h>
+#include <cmath>
+
+#include "canvas.h"
+
+template<int N>
+struct Trail {
+    static_assert(N >= 2, "trail needs at least two samples");
+
+    SDL_FPoint pts[N];
+    int head  = 0;   // next slot to write
+    int count = 0;
+
+    // Scratch buffers for the strip (2 vertices per sample)
+    SDL_Vertex verts[N * 2];
+    int indices[(N - 1) * 6];
+
+    Trail(){
+        for(int i = 0; i < N - 1; ++i){
+            int* q = &indices[i * 6];
+            q[0] = 2*i;     q[1] = 2*i + 1; q[2] = 2*i + 2;
+            q[3] = 2*i + 1; q[4] = 2*i + 3; q[5] = 2*i + 2;
+        }
+    }
+
+    void push(float x, float y){
+        pts[head] = { x, y };
+        head = (head + 1) % N;
+        if(count < N) ++count;
+    }
+
+    void clear(){ head = 0; count = 0; }
+
+    // k = 0 is the oldest sample, count-1 the newest
+    const SDL_FPoint& at(int k) const { return pts[(head - count + k + N) % N]; }
+
+    void render(Canvas& canvas, SDL_Color c, float width, bool markSamples = false){
+        if(count < 2) return;
+        for(int k = 0; k < count; ++k){
+            const SDL_FPoint& p = at(k);
+            const SDL_FPoint& a = at(k > 0 ? k - 1 : k);
+            const SDL_FPoint& b = at(k < count - 1 ? k + 1 : k);
+            float dx = b.x - a.x, dy = b.y - a.y;
+            float len = std::sqrt(dx*dx + dy*dy);
+            float nx = 0.0f, ny = 0.0f;
+            if(len > 0.0001f){ nx = -dy / len; ny = dx / len; }
+
+            float t = (k + 1) / (float)count;     // 0 = oldest, 1 = newest
+            float hw = width * 0.5f * t;
+            SDL_Color vc = c;
+            vc.a = (Uint8)(c.a * t);
+            verts[2*k]     = { { p.x + nx * hw, p.y + ny * hw }, vc, { 0, 0 } };
+            verts[2*k + 1] = { { p.x - nx * hw, p.y - ny * hw }, vc, { 0, 0 } };
+        }
+        canvas.geometry(verts, count * 2, indices, (count - 1) * 6);
+
+        if(markSamples){
+            // one dot per tick: uneven spacing = jitter, big gaps = tunneling risk
+            SDL_FRect dots[N];
+            for(int k = 0; k < count; ++k){
+                const SDL_FPoint& p = at(k);
+                dots[k] = { p.x - 1.5f, p.y - 1.5f, 3.0f, 3.0f };
+            }
+            canvas.fill_rects(dots, count, SDL_Color{255, 255, 255, 200});
+        }
+    }
+};
@@ -0,0 +1,136 @@
+// YUV4MPEG2 (.y4m) output: raw 4:2:0 frames any encoder can read, e.g.
+//   ffmpeg -i goal.y4m -c:v libx264 goal.mp4
+// RGB -> YUV is BT.601 limited range, chroma averaged over 2x2 blocks.
+// The conversion runs 8 luma / 8 chroma samples at a time with SSE2.
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TF_Y4M_SSE2 1
+#endif
+
+namespace y4m_detail {
+
+inline uint8_t luma(uint32_t p){
+    int r = (p >> 16) & 255, g = (p >> 8) & 255, b = p & 255;
+    return (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+// r, g, b are sums over a 2x2 block
+inline void chroma(int r, int g, int b, uint8_t& u, uint8_t& v){
+    r = (r + 2) >> 2; g = (g + 2) >> 2; b = (b + 2) >> 2;
+    u = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    v = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+#ifdef TF_Y4M_SSE2
+// Channel `shift` of 8 ARGB pixels as 8 x u16
+inline __m128i channel8(const uint32_t* p, int shift){
+    const __m128i mask = _mm_set1_epi32(255);
+    __m128i a = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i*)p), shift), mask);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i*)(p + 4)), shift), mask);
+    return _mm_packs_epi32(a, b);
+}
+
+// Sum of each horizontal pair of 16 pixels on two rows -> 8 x u16 (2x2 block sums)
+inline __m128i block_sum8(const uint32_t* row0, const uint32_t* row1, int shift){
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i lo = _mm_madd_epi16(_mm_add_epi16(channel8(row0, shift), channel8(row1, shift)), one);
+    __m128i hi = _mm_madd_epi16(_mm_add_epi16(channel8(row0 + 8, shift), channel8(row1 + 8, shift)), one);
+    return _mm_packs_epi32(lo, hi);
+}
+#endif
+
+} // namespace y4m_detail
+
+// argb: w x h, stride in pixels; w and h must be even. Writes w*h luma then
+// (w/2)*(h/2) U and V into out (size w*h*3/2)
+inline void rgb_to_yuv420(const uint32_t* argb, int stride, int w, int h, uint8_t* out){
+    using namespace y4m_detail;
+    uint8_t* Y = out;
+    uint8_t* U = out + (size_t)w * h;
+    uint8_t* V = U + (size_t)(w / 2) * (h / 2);
+
+    for(int y = 0; y < h; ++y){
+        const uint32_t* row = argb + (size_t)y * stride;
+        uint8_t* dst = Y + (size_t)y * w;
+        int x = 0;
+#ifdef TF_Y4M_SSE2
+        const __m128i c66 = _mm_set1_epi16(66), c129 = _mm_set1_epi16(129), c25 = _mm_set1_epi16(25);
+        const __m128i c128 = _mm_set1_epi16(128), c16 = _mm_set1_epi16(16);
+        for(; x + 8 <= w; x += 8){
+            __m128i r = channel8(row + x, 16), g = channel8(row + x, 8), b = channel8(row + x, 0);
+            // max 66*255 + 129*255 + 25*255 + 128 fits in u16
+            __m128i s = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, c66), _mm_mullo_epi16(g, c129)),
+                                      _mm_add_epi16(_mm_mullo_epi16(b, c25), c128));
+            __m128i yv = _mm_add_epi16(_mm_srli_epi16(s, 8), c16);
+            _mm_storel_epi64((__m128i*)(dst + x), _mm_packus_epi16(yv, yv));
+        }
+#endif
+        for(; x < w; ++x) dst[x] = luma(row[x]);
+    }
+
+    const int cw = w / 2;
+    for(int y = 0; y < h / 2; ++y){
+        const uint32_t* r0 = argb + (size_t)(2 * y) * stride;
+        const uint32_t* r1 = r0 + stride;
+        uint8_t* du = U + (size_t)y * cw;
+        uint8_t* dv = V + (size_t)y * cw;
+        int x = 0;
+#ifdef TF_Y4M_SSE2
+        const __m128i two = _mm_set1_epi16(2), c128 = _mm_set1_epi16(128);
+        for(; x + 8 <= cw; x += 8){
+            __m128i r = _mm_srli_epi16(_mm_add_epi16(block_sum8(r0 + 2 * x, r1 + 2 * x, 16), two), 2);
+            __m128i g = _mm_srli_epi16(_mm_add_epi16(block_sum8(r0 + 2 * x, r1 + 2 * x, 8), two), 2);
+            __m128i b = _mm_srli_epi16(_mm_add_epi16(block_sum8(r0 + 2 * x, r1 + 2 * x, 0), two), 2);
+            // signed 16-bit, |partial sums| <= 112*255
+            __m128i u = _mm_sub_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(112)), _mm_mullo_epi16(r, _mm_set1_epi16(38)));
+            u = _mm_sub_epi16(u, _mm_mullo_epi16(g, _mm_set1_epi16(74)));
+            u = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(u, c128), 8), c128);
+            __m128i v = _mm_sub_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(112)), _mm_mullo_epi16(g, _mm_set1_epi16(94)));
+            v = _mm_sub_epi16(v, _mm_mullo_epi16(b, _mm_set1_epi16(18)));
+            v = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(v, c128), 8), c128);
+            _mm_storel_epi64((__m128i*)(du + x), _mm_packus_epi16(u, u));
+            _mm_storel_epi64((__m128i*)(dv + x), _mm_packus_epi16(v, v));
+        }
+#endif
+        for(; x < cw; ++x){
+            uint32_t p[4] = { r0[2 * x], r0[2 * x + 1], r1[2 * x], r1[2 * x + 1] };
+            int r = 0, g = 0, b = 0;
+            for(uint32_t q : p){ r += (q >> 16) & 255; g += (q >> 8) & 255; b += q & 255; }
+            chroma(r, g, b, du[x], dv[x]);
+        }
+    }
+}
+
+struct Y4MWriter {
+    FILE* f = nullptr;
+    int width = 0, height = 0;
+
+    bool open(const char* path, int w, int h, int fps){
+        f = fopen(path, "wb");
+        if(!f) return false;
+        width = w; height = h;
+        fprintf(f, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", w, h, fps);
+        return true;
+    }
+
+    // yuv: one rgb_to_yuv420 output
+    bool write_frame(const uint8_t* yuv){
+        size_t size = (size_t)width * height * 3 / 2;
+        return fputs("FRAME\n", f) >= 0 && fwrite(yuv, 1, size, f) == size;
+    }
+
+    bool close(){
+        if(!f) return true;
+        bool ok = fclose(f) == 0;
+        f = nullptr;
+        return ok;
+    }
+
+    ~Y4MWriter(){ close(); }
+};
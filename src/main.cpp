@@ -10,26 +10,94 @@
 #include <SDL_ttf.h>
 #include <SDL_image.h>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <new>
+#include <filesystem>
+
+#include "pitch.h"
+#include "rng.h"
+#include "hash.h"
+#include "pitch_field.h"
+#include "sim_events.h"
+#include "particles.h"
+#include "trail.h"
+#include "debug_draw.h"
+#include "dirty_rects.h"
+#include "canvas.h"
+#include "cpu_renderer.h"
+#include "thread_pool.h"
+#include "replay.h"
+#include "y4m.h"
+#include "pitch_surface.h"
+#include "kit_cache.h"
+#include "svg_cache.h"
+#include "asset_watch.h"
+#include "log.h"
+#include "metrics.h"
+#include "quality.h"
+#include "scenario.h"
+#include "async_env.h"
+#include "policy.h"
+#include "ai_scheduler.h"
+#include "behavior_tree.h"
+#include "crowd.h"
+#include "pass_lanes.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// Screen
-constexpr int SCREEN_W = 1300;
-constexpr int SCREEN_H = 800;
-
 // Forward
 enum class Team { Blue, Red };
 struct Player;
 
+// Metrics (--metrics-port): ghi rẻ ở mọi thread, chỉ cộng dồn khi bị scrape
+constinit MetricCounter g_allocations; // mọi lần gọi operator new (kể cả trước main)
+
+void* operator new(std::size_t n){
+    g_allocations.add();
+    if(void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+struct GameMetrics {
+    MetricHistogram tick, frame, inputLatency;
+    MetricGauge matchesRunning, qualityLevel;
+    MetricCounter goalsBlue, goalsRed, frames, framesSkipped, aiPlans, aiDeferred;
+    MetricRegistry registry;
+
+    GameMetrics(){
+        registry.add("tf_tick_seconds", "Simulation update duration", tick);
+        registry.add("tf_frame_seconds", "Time to build and present a frame", frame);
+        registry.add("tf_input_latency_seconds", "Key event to the first frame presented after it", inputLatency);
+        registry.add("tf_matches_running", "Matches in progress in this process", matchesRunning);
+        registry.add("tf_quality_level", "Current quality level (0 = minimal)", qualityLevel);
+        registry.add("tf_goals_total", "Goals scored", goalsBlue, "team=\"blue\"");
+        registry.add("tf_goals_total", "Goals scored", goalsRed, "team=\"orange\"");
+        registry.add("tf_frames_total", "Frames presented", frames);
+        registry.add("tf_frames_skipped_total", "Frames skipped because nothing visible changed", framesSkipped);
+        registry.add("tf_ai_plans_total", "AI behavior tree re-plans", aiPlans);
+        registry.add("tf_ai_deferred_total", "AI re-plans pushed to the next tick by the time budget", aiDeferred);
+        registry.add("tf_allocations_total", "Heap allocations (operator new)", g_allocations);
+    }
+};
+
 // Utility
 float clampf(float v, float a, float b){ return (v<a)?a:((v>b)?b:v); }
 
+// MLP policy (--policy): 22 đặc trưng vào, 3 giá trị ra (xem Game::policy_features / policy_decode)
+constexpr int POLICY_INPUTS  = 22;
+constexpr int POLICY_OUTPUTS = 3;
+
 // =====================================
 // Ball
 // =====================================
@@ -48,6 +116,11 @@ struct Ball {
     static constexpr float MIN_STOP_SPEED   = 10.0f; // ngưỡng dừng hẳn (px/s)
     static constexpr float SPIN_COEFF       = 5.0f;  // hệ số quy đổi px/s -> độ/giây
     static constexpr float SPIN_SMOOTH      = 0.85f; // trộn mượt spinSpeed (0..1)
+    static constexpr int   DRAW_OFFSET      = 12;    // sprite vẽ lệch lên/trái so với hitbox
+    static constexpr float MIN_SPIN         = 1.0f;  // dưới ngưỡng này coi như hết xoay (độ/giây)
+
+    // Bóng nằm yên hẳn -> "ngủ", update() bỏ qua toàn bộ tích phân cho tới khi bị đánh thức
+    bool sleeping = false;
 
     Ball(int sx=SCREEN_W/2, int sy=SCREEN_H/2, int s=12){
         x = sx; y = sy; size = s;
@@ -61,17 +134,22 @@ struct Ball {
         return { (int)std::round(x), (int)std::round(y), size, size };
     }
 
-    void reset(bool towardsLeft){
-        x = SCREEN_W/2 - size/2;
-        y = SCREEN_H/2 - size/2;
+    void reset(bool towardsLeft, Pcg32& rng){
+        x = PITCH.bounds.centerX() - size/2;
+        y = PITCH.bounds.centerY() - size/2;
         vx = (towardsLeft? -1.0f : 1.0f) * 280.0f;
-        vy = 80.0f * ((rand()%100)/100.0f - 0.5f);
+        vy = 80.0f * rng.range(-0.5f, 0.5f);
         // reset xoay nhẹ
         spinSpeed = 0.0f;
         angle = 0.0f;
+        sleeping = false;
     }
 
+    void wake(){ sleeping = false; }
+
     void update(float dt){
+        if(sleeping) return;
+
         // 1) Cập nhật vị trí
         x += vx * dt;
         y += vy * dt;
@@ -103,6 +181,12 @@ struct Ball {
         // 7) Chuẩn hoá góc về [0,360)
         while (angle >= 360.0f) angle -= 360.0f;
         while (angle <    0.0f) angle += 360.0f;
+
+        // 8) Đứng yên và hết xoay -> ngủ
+        if (vx == 0.0f && vy == 0.0f && fabsf(spinSpeed) < MIN_SPIN) {
+            spinSpeed = 0.0f;
+            sleeping = true;
+        }
     }
 
     // Kick ball from a player position with given force
@@ -124,6 +208,7 @@ struct Ball {
 
             float side = (dx >= 0.0f) ? 1.0f : -1.0f; // xoáy phụ thuộc hướng x
             spinSpeed += side * 250.0f;
+            sleeping = false;
         }
     }
 };
@@ -160,11 +245,13 @@ struct Player {
     bool active = true;
     bool isAI = false;
     float kickRange = 50.0f; // tăng nhẹ cho dễ sút
+    static constexpr float KICK_FORCE = 450.0f; // px/s cộng vào bóng
 
     // textures Kenney
     SDL_Texture* texBody = nullptr;
     SDL_Texture* texArm  = nullptr;
     SDL_Texture* texLeg  = nullptr;
+    int kit = 0; // index vào KITS; texture lấy từ KitCache mỗi frame (Game::bind_kits)
 
     Team team = Team::Blue;
     SDL_Color jerseyTint = {255,255,255,255};
@@ -177,6 +264,26 @@ struct Player {
     float animTime = 0.0f;
     float moveX = 0, moveY = 0;
 
+    // mục tiêu AI (tâm), để vẽ debug
+    float aiTargetX = 0, aiTargetY = 0;
+    float aiUrgency = 0.8f;
+    bool aiKick = false; // lá "kick" của behavior tree, Game sút ở cuối lượt AI
+    float carryX = 0, carryY = 0; // phần lẻ pixel của move_velocity
+    float aiVx = 0, aiVy = 0;     // vận tốc AI tick trước (ORCA cần vận tốc hiện tại)
+    float aiAimX = 1, aiAimY = 0; // hướng đã ngắm (aim_pass / aim_shot), đơn vị
+
+    // Không có input và đã đứng yên hẳn trong tick này (Game bỏ qua va chạm khi mọi thứ idle)
+    bool idle = false;
+
+    bool settled() const { return fabsf(visX - r.x) < 0.05f && fabsf(visY - r.y) < 0.05f; }
+
+    void settle(){
+        visX = (float)r.x; visY = (float)r.y;
+        moveX = 0; moveY = 0;
+        animTime = 0;
+        idle = true;
+    }
+
     Player(int x=0,int y=0,int w=BODY_W,int h=BODY_H){
         r.x=x; r.y=y; r.w=w; r.h=h;
         visX = (float)x;  // để cả cầu thủ inactive vẫn xuất hiện
@@ -184,12 +291,21 @@ struct Player {
     }
 
     void update_from_keyboard(const Uint8* keystate, float dt){
-        if(!active || isAI) return;
+        if(isAI) return;
+        if(!active){ idle = true; return; }
         int dy = 0, dx = 0;
         if(keystate[up]) dy -= 1;
         if(keystate[down]) dy += 1;
         if(keystate[left]) dx -= 1;
         if(keystate[right]) dx += 1;
+        move(dx, dy, dt);
+    }
+
+    // Chạy theo hướng (dx, dy) ∈ {-1,0,1}²: bàn phím hoặc policy (--policy)
+    void move(int dx, int dy, float dt){
+        // không bấm phím và đã về đúng chỗ -> idle, bỏ qua phần còn lại
+        if(dx == 0 && dy == 0 && animTime == 0 && settled()){ settle(); return; }
+        idle = false;
         float len = std::sqrt((float)(dx*dx + dy*dy));
         if(len > 0.01f){ dx = (int)std::round(dx/len); dy = (int)std::round(dy/len); }
         moveX = (float)dx;
@@ -198,8 +314,8 @@ struct Player {
         r.x += (int)std::round(dx * speed * dt);
         r.y += (int)std::round(dy * speed * dt);
 
-        r.x = (int)clampf(r.x, 0, SCREEN_W - r.w);
-        r.y = (int)clampf(r.y, 0, SCREEN_H - r.h);
+        r.x = (int)clampf(r.x, PITCH.bounds.left(), PITCH.bounds.right() - r.w);
+        r.y = (int)clampf(r.y, PITCH.bounds.top(), PITCH.bounds.bottom() - r.h);
 
         if(dx != 0 || dy != 0) animTime += dt; else animTime = 0;
 
@@ -207,17 +323,34 @@ struct Player {
         visY += ((float)r.y - visY) * clampf(smooth * dt, 0.f, 1.f);
     }
 
-    void update_AI(const Ball& b, float dt){
-        if(!isAI) return;
-        float targetY = b.y + b.size/2 - r.h/2;
-        float dy = targetY - r.y;
-        moveX = 0; moveY = 0;
-        if(std::abs(dy) > 6){
-            float dir = (dy>0)?1:-1;
-            r.y += (int)std::round(dir * speed * dt * 0.8f);
-            moveY = dir;
-        }
-        r.y = (int)clampf(r.y, 0, SCREEN_H - r.h);
+    // Vận tốc AI muốn (px/s): về phía mục tiêu (aiTargetX/Y, tâm) với speed * aiUrgency từng trục,
+    // 0 khi đã cách mục tiêu <= 6px. Mục tiêu do behavior tree đặt
+    void ai_preferred_velocity(float& vx, float& vy) const {
+        float dx = aiTargetX - r.w/2 - r.x;
+        float dy = aiTargetY - r.h/2 - r.y;
+        const float v = speed * aiUrgency;
+        vx = std::abs(dx) > 6 ? (dx > 0 ? v : -v) : 0.0f;
+        vy = std::abs(dy) > 6 ? (dy > 0 ? v : -v) : 0.0f;
+    }
+
+    // Đi với vận tốc (px/s) của AI (sau tránh va chạm); phần lẻ dưới 1px dồn sang tick sau
+    // để vận tốc nhỏ khi né nhau không bị làm tròn mất
+    void move_velocity(float vx, float vy, float dt){
+        if(std::abs(vx) < 1.0f && std::abs(vy) < 1.0f && animTime == 0 && settled()){ settle(); return; }
+        idle = false;
+        float fx = vx * dt + carryX, fy = vy * dt + carryY;
+        int ix = (int)std::round(fx), iy = (int)std::round(fy);
+        carryX = fx - ix; carryY = fy - iy;
+        r.x += ix;
+        r.y += iy;
+        const float still = speed * 0.1f; // dưới mức này không tính là đang chạy (animation)
+        moveX = vx > still ? 1.0f : (vx < -still ? -1.0f : 0.0f);
+        moveY = vy > still ? 1.0f : (vy < -still ? -1.0f : 0.0f);
+
+        int cx = (int)clampf(r.x, PITCH.bounds.left(), PITCH.bounds.right() - r.w);
+        int cy = (int)clampf(r.y, PITCH.bounds.top(), PITCH.bounds.bottom() - r.h);
+        if(cx != r.x){ r.x = cx; carryX = 0; }
+        if(cy != r.y){ r.y = cy; carryY = 0; }
         if(moveX != 0 || moveY != 0) animTime += dt; else animTime = 0;
 
         visX += ((float)r.x - visX) * clampf(smooth * dt, 0.f, 1.f);
@@ -233,25 +366,26 @@ struct Player {
         return (dx*dx + dy*dy) <= (kickRange*kickRange);
     }
 
-    void kickBall(Ball& ball) const {
+    bool kickBall(Ball& ball) const {
         if(canKickBall(ball)){
             float cx = r.x + r.w/2.0f;
             float cy = r.y + r.h/2.0f;
-            ball.kick(cx, cy, 450.0f);
+            ball.kick(cx, cy, KICK_FORCE);
+            return true;
         }
+        return false;
     }
 
-void render(SDL_Renderer* renderer){
+// shadow / limbDetail (2 tay + chân, 1 chỉ chân, 0 chỉ thân): theo QualitySettings
+void render(Canvas& canvas, bool shadow = true, int limbDetail = 2){
     // Fallback nếu thiếu sprite → vẽ rect màu đội
     if(!texBody || !texLeg){
-        if(team == Team::Blue) SDL_SetRenderDrawColor(renderer, 80,150,255,255);
-        else                   SDL_SetRenderDrawColor(renderer, 255,170,60,255);
+        SDL_Color teamColor = (team == Team::Blue) ? SDL_Color{80,150,255,255} : SDL_Color{255,170,60,255};
         SDL_Rect rr = { (int)std::round(visX), (int)std::round(visY), r.w, r.h };
-        SDL_RenderFillRect(renderer, &rr);
+        canvas.fill_rect(rr, teamColor);
         if(active){
-            SDL_SetRenderDrawColor(renderer, 255,235,80,230);
             SDL_Rect bd = { rr.x-2, rr.y-2, rr.w+4, rr.h+4 };
-            SDL_RenderDrawRect(renderer, &bd);
+            canvas.draw_rect(bd, SDL_Color{255,235,80,230});
         }
         return;
     }
@@ -262,10 +396,10 @@ void render(SDL_Renderer* renderer){
     const float cx  = baseX + BODY_W * 0.5f;
     const float cy  = baseY + BODY_H * 0.5f;
 
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(renderer, 0,0,0,70);
-    SDL_Rect shadow = { (int)(cx - BODY_W*0.25f), (int)(baseY + BODY_H - 8), BODY_W/2, 7 };
-    SDL_RenderFillRect(renderer, &shadow);
+    if(shadow){
+        SDL_Rect shadowRect = { (int)(cx - BODY_W*0.25f), (int)(baseY + BODY_H - 8), BODY_W/2, 7 };
+        canvas.fill_rect(shadowRect, SDL_Color{0,0,0,70});
+    }
 
 // ===== 2) Hướng nhìn (idle nhìn xuống)
 float angleDeg = atan2f(moveY, moveX) * 180.0f / (float)M_PI;
@@ -310,11 +444,11 @@ const float hipRy = hipBaseY + LEG_SPREAD * ry - stepF * fy;
     // ===== 4) Vẽ theo "điểm khớp" (pivot)
     auto drawAtPivot = [&](SDL_Texture* tex, float jx, float jy,
                            int w, int h, float deg,
-                           int pivotX, int pivotY)
+                           int pivotX, int pivotY, SDL_Color tint)
     {
         SDL_Rect dst{ int(jx - pivotX), int(jy - pivotY), w, h };
         SDL_Point pivot{ pivotX, pivotY };
-        SDL_RenderCopyEx(renderer, tex, nullptr, &dst, deg, &pivot, SDL_FLIP_NONE);
+        canvas.copy_ex(tex, nullptr, &dst, deg, &pivot, SDL_FLIP_NONE, tint);
     };
 
     // Pivot của sprite (điểm dính vào thân)
@@ -322,10 +456,11 @@ const float hipRy = hipBaseY + LEG_SPREAD * ry - stepF * fy;
     const int ARM_PIVOT_R_X = int(ARM_W * 0.15f), ARM_PIVOT_R_Y = ARM_H/2; // tay phải: mép trong
     const int LEG_PIVOT_X   = LEG_W/2,            LEG_PIVOT_Y   = int(LEG_H * 0.10f); // đỉnh trên
 
-    // ===== 5) Tint đồng phục
-    SDL_SetTextureColorMod(texBody, jerseyTint.r, jerseyTint.g, jerseyTint.b);
-    SDL_SetTextureColorMod(texLeg,  jerseyTint.r, jerseyTint.g, jerseyTint.b);
-    if (texArm) SDL_SetTextureColorMod(texArm, jerseyTint.r, jerseyTint.g, jerseyTint.b);
+    // ===== 5) Tint đồng phục (truyền theo từng lần vẽ, không gắn vào texture)
+    const SDL_Color jersey = { jerseyTint.r, jerseyTint.g, jerseyTint.b, 255 };
+    auto shade = [&](float k){
+        return SDL_Color{ (Uint8)(jerseyTint.r*k), (Uint8)(jerseyTint.g*k), (Uint8)(jerseyTint.b*k), 255 };
+    };
 
     // Xác định "bên trước" theo pha bước chạy; khi đứng yên giữ mặc định tay trái trước
     const bool moving = (fabsf(moveX) > 0.1f || fabsf(moveY) > 0.1f);
@@ -336,16 +471,14 @@ const float hipRy = hipBaseY + LEG_SPREAD * ry - stepF * fy;
     // ===== 6) LỚP VẼ: CHÂN → TAY → BODY =====
 
     // --- CHÂN (cả hai chân vẽ TRƯỚC tay & body)
-    SDL_SetTextureColorMod(texLeg,
-        (Uint8)(jerseyTint.r*0.88f),
-        (Uint8)(jerseyTint.g*0.88f),
-        (Uint8)(jerseyTint.b*0.88f));          // hơi tối cho có chiều sâu
-    drawAtPivot(texLeg, hipLx, hipLy, LEG_W, LEG_H, angleDeg, LEG_PIVOT_X, LEG_PIVOT_Y);
-    drawAtPivot(texLeg, hipRx, hipRy, LEG_W, LEG_H, angleDeg, LEG_PIVOT_X, LEG_PIVOT_Y);
-    SDL_SetTextureColorMod(texLeg, jerseyTint.r, jerseyTint.g, jerseyTint.b);
+    const SDL_Color legTint = shade(0.88f);   // hơi tối cho có chiều sâu
+    if(limbDetail >= 1){
+        drawAtPivot(texLeg, hipLx, hipLy, LEG_W, LEG_H, angleDeg, LEG_PIVOT_X, LEG_PIVOT_Y, legTint);
+        drawAtPivot(texLeg, hipRx, hipRy, LEG_W, LEG_H, angleDeg, LEG_PIVOT_X, LEG_PIVOT_Y, legTint);
+    }
 
     // --- TAY (nằm TRÊN chân nhưng DƯỚI body) ---
-if (texArm) {
+if (texArm && limbDetail >= 2) {
     // Pha đánh tay (ngược pha với chân để chạy tự nhiên hơn)
     float armSwing = sinf(animTime * 6.0f) * 35.0f;
 
@@ -355,37 +488,32 @@ if (texArm) {
     bool leftArmFront = moving ? (armSwing > 0.0f) : true;
 
     // --- Tay sau (làm tối màu 15%) ---
-    SDL_SetTextureColorMod(texArm,
-        (Uint8)(jerseyTint.r * 0.85f),
-        (Uint8)(jerseyTint.g * 0.85f),
-        (Uint8)(jerseyTint.b * 0.85f));
+    const SDL_Color backArmTint = shade(0.85f);
 
     if (leftArmFront) {
         // Tay phải là tay sau
         drawAtPivot(texArm, shoulderRx, shoulderRy, ARM_W, ARM_H,
                     angleDeg - armSwing + 180.0f,
-                    ARM_PIVOT_R_X, ARM_PIVOT_R_Y);
+                    ARM_PIVOT_R_X, ARM_PIVOT_R_Y, backArmTint);
     } else {
         // Tay trái là tay sau
         drawAtPivot(texArm, shoulderLx, shoulderLy, ARM_W, ARM_H,
                     angleDeg + armSwing + 180.0f,
-                    ARM_PIVOT_L_X, ARM_PIVOT_L_Y);
+                    ARM_PIVOT_L_X, ARM_PIVOT_L_Y, backArmTint);
     }
 
     // --- Tay trước (giữ màu gốc) ---
-    SDL_SetTextureColorMod(texArm,
-        jerseyTint.r, jerseyTint.g, jerseyTint.b);
 
     if (leftArmFront) {
         // Tay trái là tay trước
         drawAtPivot(texArm, shoulderLx, shoulderLy, ARM_W, ARM_H,
                     angleDeg + armSwing,
-                    ARM_PIVOT_L_X, ARM_PIVOT_L_Y);
+                    ARM_PIVOT_L_X, ARM_PIVOT_L_Y, jersey);
     } else {
         // Tay phải là tay trước
         drawAtPivot(texArm, shoulderRx, shoulderRy, ARM_W, ARM_H,
                     angleDeg - armSwing,
-                    ARM_PIVOT_R_X, ARM_PIVOT_R_Y);
+                    ARM_PIVOT_R_X, ARM_PIVOT_R_Y, jersey);
     }
 }
 
@@ -393,20 +521,91 @@ if (texArm) {
 
     // --- BODY (vẽ CUỐI CÙNG)
     SDL_Rect dstBody{ int(cx - BODY_W*0.5f), int(cy - BODY_H*0.5f), BODY_W, BODY_H };
-    SDL_RenderCopyEx(renderer, texBody, nullptr, &dstBody, angleDeg, nullptr, SDL_FLIP_NONE);
+    canvas.copy_ex(texBody, nullptr, &dstBody, angleDeg, nullptr, SDL_FLIP_NONE, jersey);
 
     // Viền người active
     if (active){
-        SDL_SetRenderDrawColor(renderer, 255,235,80,230);
         SDL_Rect border{ dstBody.x-2, dstBody.y-2, dstBody.w+4, dstBody.h+4 };
-        SDL_RenderDrawRect(renderer, &border);
+        canvas.draw_rect(border, SDL_Color{255,235,80,230});
     }
+}
+};
 
-    // reset tint
-    SDL_SetTextureColorMod(texBody, 255,255,255);
-    SDL_SetTextureColorMod(texLeg,  255,255,255);
-    if (texArm) SDL_SetTextureColorMod(texArm, 255,255,255);
+// =====================================
+// AI behavior tree (--ai-tree): cây đọc từ data/ai/*.bt, biên dịch thành bytecode,
+// lá do AiLeaves tính. Cây chỉ đặt mục tiêu/tốc độ/sút; di chuyển qua tránh va chạm (crowd.h)
+// =====================================
+enum AiLeaf : uint8_t {
+    AI_BALL_NEAR_OWN_GOAL, AI_BALL_IN_OWN_HALF, AI_BALL_WITHIN, AI_CAN_KICK,
+    AI_TRACK_BALL_Y, AI_CHASE_BALL, AI_URGENCY, AI_KICK,
+    AI_PASS_OPEN, AI_SHOT_OPEN, AI_AIM_PASS, AI_AIM_SHOT, AI_AIMED, AI_LEAF_COUNT
+};
+
+constexpr BtLeafDef AI_LEAVES[] = {
+    { "ball_near_own_goal", 1, 1 }, // bóng cách khung thành đội mình phòng thủ < R
+    { "ball_in_own_half",   0, 0 },
+    { "ball_within",        1, 1 }, // bóng cách cầu thủ < R
+    { "can_kick",           0, 0 },
+    { "track_ball_y",       0, 0 }, // giữ x, bám y của bóng trong vùng 5m50 nhà
+    { "chase_ball",         0, 0 },
+    { "urgency",            1, 1 }, // tốc độ tới mục tiêu = U x speed
+    { "kick",               0, 0 },
+    { "pass_open",          1, 1 }, // đang giữ bóng và có đường chuyền điểm >= S (PlayOptions)
+    { "shot_open",          1, 1 }, // đang giữ bóng và có cửa sút điểm >= S
+    { "aim_pass",           0, 0 }, // mục tiêu: sau bóng, thẳng hàng với đường chuyền tốt nhất
+    { "aim_shot",           0, 0 }, // mục tiêu: sau bóng, thẳng hàng với cửa sút tốt nhất
+    { "aimed",              1, 1 }, // hướng sút hiện tại lệch hướng đã ngắm < DEG độ
+};
+static_assert(sizeof(AI_LEAVES) / sizeof(AI_LEAVES[0]) == AI_LEAF_COUNT, "AI_LEAVES out of sync with AiLeaf");
+
+// Giống data/ai/default.bt (scenario ai_tree_sync kiểm tra): dùng khi không có file (headless, chạy ngoài build/)
+constexpr const char* DEFAULT_AI_TREE_FILE = "../data/ai/default.bt";
+constexpr const char* DEFAULT_AI_TREE = R"(
+sequence
+  track_ball_y
+  selector
+    sequence
+      ball_near_own_goal 122
+      urgency 1.0
+    urgency 0.8
+)";
+
+const BtProgram& default_ai_tree(){
+    static const BtProgram prog = []{
+        BtProgram p;
+        std::string err;
+        if(!p.compile(DEFAULT_AI_TREE, AI_LEAVES, AI_LEAF_COUNT, err, "default")) LOG_ERROR("AI tree: %s", err.c_str());
+        return p;
+    }();
+    return prog;
 }
+
+// Đường chuyền / cửa sút của người giữ bóng một đội (Game::evaluate_play, pass_lanes.h)
+struct PlayOptions {
+    static constexpr int SHOT_SAMPLES = 8; // điểm rải đều trên khung thành đối phương
+    static constexpr int MAX_PASSES = LaneEvaluator::MAX_TARGETS - SHOT_SAMPLES;
+
+    int carrier = -1;                 // cầu thủ gần bóng nhất của đội
+    int passCount = 0;
+    int passTo[MAX_PASSES];           // index cầu thủ
+    float passScore[MAX_PASSES];      // 0..1, LaneEvaluator::score
+    float shotX[SHOT_SAMPLES], shotY[SHOT_SAMPLES], shotScore[SHOT_SAMPLES];
+    int bestPass = -1, bestShot = -1; // index trong passTo / shot*
+    float shotWindow = 0.0f;          // tỉ lệ điểm trên khung thành bóng tới trước mọi đối thủ
+
+    float best_pass_score() const { return bestPass < 0 ? 0.0f : passScore[bestPass]; }
+    float best_shot_score() const { return bestShot < 0 ? 0.0f : shotScore[bestShot]; }
+};
+
+struct Game;
+
+// Lá của cây AI cho một cầu thủ; định nghĩa sau Game (cần Game::play_options)
+struct AiLeaves {
+    Game& g;
+    Player& p;
+
+    BtStatus leaf(const BtInstr& in);
+    bool aim_at(float tx, float ty);
 };
 
 // =====================================
@@ -468,75 +667,323 @@ struct Game {
     std::vector<Player> players; // left players first, then right
     ScoreBoard score;
 
+    uint64_t seed = 0;  // seed của trận, in ra để chạy lại y hệt
+    Pcg32 rng;          // random riêng của trận (không dùng rand() toàn cục)
+
     bool autoSelectEnabled = true; // toggle tự động chọn player
     float autoSelectCooldown = 0.0f; // cooldown giữa các lần chọn
     const float AUTO_SELECT_INTERVAL = 0.3f; // chỉ chọn lại sau 0.3 giây
 
     bool showDebug = false;
+    bool worldIdle = false; // tick trước không có gì chuyển động
+
+    // Render-on-demand: chỉ vẽ lại khi trạng thái nhìn thấy được thay đổi
+    uint64_t lastFrameHash = 0;
+    bool forceRedraw = true;   // expose/restore/resize... bắt buộc vẽ lại
+    int framesSkipped = 0;
+    Uint32 pendingInputTicks = 0; // timestamp phím sớm nhất chưa được vẽ ra (đo input latency)
+    GameMetrics metrics;
+    MetricsServer metricsServer;
+
+    // Quality governor: hạ/tăng phần việc tùy chọn để giữ 60fps (--quality để cố định)
+    QualityGovernor quality;
+    Uint64 lastPresentAt = 0;
+    bool presentStreak = false;   // frame trước cũng được vẽ → khoảng cách giữa 2 lần present có nghĩa
+    double presentWait = 0.0;     // giây nằm trong SDL_RenderPresent (vsync) của frame vừa vẽ
+    double renderWork = 0.0;      // giây CPU của frame vừa vẽ, không tính presentWait
+    uint32_t aiTick = 0;
+    const Uint8* scriptedKeys = nullptr; // != null: input từ scenario thay cho bàn phím
+    const MlpPolicy* policy = nullptr;   // --policy: AI chạy MLP thay cho behavior tree
+    BtProgram aiTree = default_ai_tree();
+    std::string aiTreePath;              // --ai-tree: file đã nạp (hot reload), rỗng = cây mặc định
+    std::vector<float> aiBlackboard;     // players x aiTree.slots
+    float aiClock = 0.0f;                // giây, cho cooldown trong cây
+    AiScheduler aiSchedule;              // ai replan tick nào: lệch pha, theo sự kiện, trong ngân sách thời gian
+    int aiReplanTicks = 4;               // --ai-replan-ticks: chu kỳ replan; quality chỉ kéo dài thêm
+    int lastTouchTeam = -1;              // đội chạm bóng gần nhất (đổi đội = đổi quyền kiểm soát)
+    CrowdAvoidance crowd;                // ORCA giữa các cầu thủ, AI né
+    bool avoidance = true;               // --no-avoidance: AI đi thẳng tới mục tiêu
+    static constexpr float AVOID_RADIUS = 16.0f; // ~nửa chiều cao thân
+    LaneEvaluator lanes;                 // đường chuyền / cửa sút (PlayOptions)
+    PlayOptions playOptions[2];          // [0] xanh, [1] cam, tính lại tối đa 1 lần mỗi tick
+    uint32_t playOptionsTick[2] = { UINT32_MAX, UINT32_MAX };
+    std::vector<std::pair<float, int>> laneScratch;
+    std::vector<float> policyIn, policyOut;
+    std::vector<int> policyPlayers;
     bool aiEnabled = false; // let player 7 be AI
 
     float goalMessageTimer = 0.0f;
 
+    SimEventQueue events;    // sự kiện trong frame hiện tại
+    ParticlePool particles;  // hiệu ứng cỏ, bụi, pháo giấy
+
+    static constexpr int BALL_TRAIL_LEN   = 48;
+    static constexpr int PLAYER_TRAIL_LEN = 32;
+    Trail<BALL_TRAIL_LEN> ballTrail;                   // vệt bóng
+    std::vector<Trail<PLAYER_TRAIL_LEN>> playerTrails; // vệt cầu thủ (chỉ ở debug mode)
+
+    DebugDraw debugDraw; // hình học debug: F3 hitbox, F4 vùng sút, F5 vận tốc, F6 AI
+
+    KitCache kits;              // áo đấu nạp khi cần, LRU theo ngân sách bộ nhớ texture
+    int homeKit = 0, awayKit = 1; // đội xanh (trái) / đội cam (phải), F7 / F8 để đổi
+
     Game(){ }
 
+    void seed_match(uint64_t matchSeed, uint64_t stream = 0){
+        seed = matchSeed;
+        rng = Pcg32::stream(matchSeed, stream);
+        particles.rng = (uint32_t)Pcg32::stream(matchSeed, stream + 1).next() | 1u;
+    }
+
+    // Số pixel ra trên 1 đơn vị màn hình (HiDPI, --export-size)
+    float art_scale(){
+        if(artScale > 0.0f) return artScale;
+        int w = SCREEN_W, h = SCREEN_H;
+        if(SDL_GetRendererOutputSize(renderer, &w, &h) != 0) return 1.0f;
+        return std::max(w / (float)SCREEN_W, 1.0f);
+    }
+
+    // Nền sân: 1 tile cỏ lặp lại + vạch vẽ theo PITCH, dựng đúng độ phân giải cửa sổ.
+    // pngSheet: tilesheet đã decode sẵn (hot reload), không thì tự nạp
+    SDL_Texture* build_pitch_texture(SDL_Surface* pngSheet = nullptr){
+        SDL_Surface* sheet = nullptr;
+        SDL_Rect tile = GRASS_TILE;
+        float k = 1.0f;
+        if(svgArt){
+            // tilesheet 13x16 ô; rasterize để 1 ô cỏ = đúng số pixel nó chiếm khi vẽ
+            int t = std::max(1, (int)lroundf(GRASS_TILE.w * art_scale()));
+            SDL_Rect crop = { 0, 0, t, t };
+            sheet = svg.rasterize(GRASS_SHEET_SVG, 13 * t, 16 * t, &crop);
+            if(sheet){ tile = crop; k = t / (float)GRASS_TILE.w; }
+        }
+        if(!sheet) sheet = pngSheet ? pngSheet : IMG_Load(GRASS_SHEET_PNG);
+        if(!sheet){
+            LOG_WARN("Grass tilesheet not found (%s)", IMG_GetError());
+            return nullptr;
+        }
+        SDL_Surface* surf = build_pitch_surface(sheet, tile, PITCH, (int)lroundf(SCREEN_W * k), (int)lroundf(SCREEN_H * k), k);
+        if(sheet != pngSheet) SDL_FreeSurface(sheet);
+        if(!surf) return nullptr;
+        SDL_Texture* tex = texture_from_surface(surf);
+        if(tex) SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE); // nền đặc, không cần blend
+        SDL_FreeSurface(surf);
+        return tex;
+    }
+
+    // Cầu môn = ô (4,4) của tilesheet elements 9x9 (PNG/Elements/element (41).png)
+    SDL_Texture* load_goal_texture(){
+        if(svgArt){
+            const PitchRect& r = PITCH.goals[0].sprite;
+            int tw = std::max(1, (int)lroundf(r.w * art_scale()));
+            int th = std::max(1, (int)lroundf(r.h * art_scale()));
+            SDL_Rect crop = { 4 * tw, 4 * th, tw, th };
+            if(SDL_Surface* surf = svg.rasterize(ELEMENTS_SVG, 9 * tw, 9 * th, &crop)){
+                SDL_Texture* tex = texture_from_surface(surf);
+                SDL_FreeSurface(surf);
+                if(tex) return tex;
+            }
+        }
+        return load_texture("../kenney_sports-pack/PNG/Elements/element (41).png");
+    }
+
+    // Ở chế độ CPU raster giữ thêm bản pixel cho rasterizer
+    SDL_Texture* texture_from_surface(SDL_Surface* surf){
+        SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surf);
+        if(tex && cpuRaster) cpu.add_image(tex, surf);
+        return tex;
+    }
+
+    SDL_Texture* load_texture(const char* path){
+        SDL_Texture* tex = nullptr;
+        if(!cpuRaster){
+            tex = IMG_LoadTexture(renderer, path);
+        } else if(SDL_Surface* surf = IMG_Load(path)){
+            tex = texture_from_surface(surf);
+            SDL_FreeSurface(surf);
+        }
+        if(tex && hotReload){
+            texturePaths[path] = tex;
+            assetWatch.watch(path);
+        }
+        return tex;
+    }
+
+    void destroy_texture(SDL_Texture* tex){
+        if(!tex) return;
+        std::erase_if(texturePaths, [tex](const auto& kv){ return kv.second == tex; });
+        cpu.remove_image(tex);
+        SDL_DestroyTexture(tex);
+    }
+
+    // Mở 3 cỡ chữ từ một file; giữ font cũ nếu file mới hỏng
+    bool open_fonts(const std::string& path){
+        TTF_Font* f = TTF_OpenFont(path.c_str(), 22);
+        TTF_Font* fs = TTF_OpenFont(path.c_str(), 16);
+        TTF_Font* fl = TTF_OpenFont(path.c_str(), 72);
+        if(!f || !fs || !fl){
+            if(f) TTF_CloseFont(f);
+            if(fs) TTF_CloseFont(fs);
+            if(fl) TTF_CloseFont(fl);
+            return false;
+        }
+        if(font) TTF_CloseFont(font);
+        if(font_small) TTF_CloseFont(font_small);
+        if(font_large) TTF_CloseFont(font_large);
+        font = f; font_small = fs; font_large = fl;
+        fontPath = path;
+        return true;
+    }
+
+    // Bản pixel mới cùng kích thước → ghi đè thẳng vào texture (mọi chỗ đang giữ con trỏ vẫn đúng)
+    bool patch_texture(SDL_Texture* tex, SDL_Surface* surf){
+        Uint32 format = 0;
+        int w = 0, h = 0;
+        if(SDL_QueryTexture(tex, &format, nullptr, &w, &h) != 0) return false;
+        if(surf->w != w || surf->h != h){
+            LOG_WARN("Hot reload: size changed %dx%d -> %dx%d, restart to pick it up", w, h, surf->w, surf->h);
+            return false;
+        }
+        SDL_Surface* conv = surf->format->format == format ? surf : SDL_ConvertSurfaceFormat(surf, format, 0);
+        if(!conv) return false;
+        bool ok = SDL_UpdateTexture(tex, nullptr, conv->pixels, conv->pitch) == 0;
+        if(conv != surf) SDL_FreeSurface(conv);
+        if(ok && cpuRaster) cpu.add_image(tex, surf);
+        return ok;
+    }
+
+    bool reload_asset(const AssetChange& c){
+        if(c.path == fontPath) return open_fonts(std::string(c.path));
+        if(c.path == aiTreePath) return load_ai_tree(c.path);
+        if(c.path == GRASS_SHEET_PNG || c.path == GRASS_SHEET_SVG){
+            SDL_Texture* tex = build_pitch_texture(c.surf);
+            if(!tex) return false;
+            destroy_texture(bgTex);
+            bgTex = tex;
+            build_static_background();
+            return true;
+        }
+        if(c.path == ELEMENTS_SVG){
+            SDL_Texture* tex = load_goal_texture();
+            if(!tex) return false;
+            destroy_texture(elementsTex);
+            elementsTex = tex;
+            return true;
+        }
+        auto it = texturePaths.find(c.path);
+        if(it == texturePaths.end() || !c.surf) return false;
+        if(!patch_texture(it->second, c.surf)) return false;
+        if(it->second == bgTex) build_static_background(); // nền JPG dự phòng: lớp tĩnh chụp từ nó
+        return true;
+    }
+
+    // Gọi mỗi vòng lặp trên main thread
+    void poll_assets(){
+        if(!hotReload) return;
+        for(AssetChange& c : assetWatch.take()){
+            bool ok = reload_asset(c);
+            if(ok) LOG_INFO("Reloaded %s", c.path);
+            else LOG_WARN("Could not reload %s", c.path);
+            if(c.surf) SDL_FreeSurface(c.surf);
+            if(ok) forceRedraw = true;
+        }
+    }
+
     bool init(const char* title="Tiny Football (SDL2)"){
         if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0){
-            printf("SDL_Init Error: %s\n", SDL_GetError());
+            LOG_ERROR("SDL_Init: %s", SDL_GetError());
             return false;
         }
         if(TTF_Init() != 0){
-            printf("TTF_Init Error: %s\n", TTF_GetError());
+            LOG_ERROR("TTF_Init: %s", TTF_GetError());
             return false;
         }
 
-        window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_W, SCREEN_H, SDL_WINDOW_SHOWN);
+        window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_W, SCREEN_H, hiddenWindow ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN);
         SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
-        if(!window){ printf("CreateWindow failed: %s\n", SDL_GetError()); return false; }
-        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        if(!window){ LOG_ERROR("CreateWindow failed: %s", SDL_GetError()); return false; }
+        if(!softwareRender){
+            renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+            if(!renderer){
+                LOG_WARN("Accelerated renderer unavailable (%s), using software renderer", SDL_GetError());
+                softwareRender = true;
+            }
+        }
+        if(softwareRender){
+            // vẽ thẳng lên window surface để present được từng vùng (SDL_UpdateWindowSurfaceRects)
+            SDL_Surface* windowSurface = SDL_GetWindowSurface(window);
+            renderer = windowSurface ? SDL_CreateSoftwareRenderer(windowSurface) : nullptr;
+        }
         if ((IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) & (IMG_INIT_PNG | IMG_INIT_JPG)) == 0) {
-        printf("IMG_Init Error: %s\n", IMG_GetError());
+        LOG_WARN("IMG_Init: %s", IMG_GetError());
          // vẫn chạy tiếp được nếu thiếu decoder, nhưng nên có ảnh PNG/JPG
         }
-        if(!renderer){ printf("CreateRenderer failed: %s\n", SDL_GetError()); return false; }
+        if(!renderer){ LOG_ERROR("CreateRenderer failed: %s", SDL_GetError()); return false; }
+
+        canvas.renderer = renderer;
+        if(cpuRaster){
+            workers = std::make_unique<ThreadPool>();
+            cpu.init(workers.get());
+            canvas.list = &cpu.list;
+            canvas.images = &cpu.images;
+            LOG_INFO("CPU raster: %d threads, %s", workers->size(), cpu.avx2 ? "AVX2" : "SSE2");
+        }
+
+        pitch_field(); // bake distance field once at startup
 
-        SDL_Texture* texBall = IMG_LoadTexture(renderer, "../kenney_sports-pack/PNG/Equipment/ball_soccer2.png");
+        SDL_Texture* texBall = load_texture("../kenney_sports-pack/PNG/Equipment/ball_soccer2.png");
         if(!texBall){
-            printf("Error loading ball texture: %s\n", IMG_GetError());
+            LOG_ERROR("Could not load ball texture: %s", IMG_GetError());
         }
         ball.tex = texBall;
-        ball.size = 20;
 
-        bgTex = IMG_LoadTexture(renderer, "../kenney_sports-pack/soccer-field-background-vector.jpg");
+        bgTex = build_pitch_texture();
+        if(!bgTex){
+            // thiếu tilesheet → dùng ảnh sân cũ
+            bgTex = load_texture("../kenney_sports-pack/soccer-field-background-vector.jpg");
+        }
         if(!bgTex){
-            printf("IMG_LoadTexture Error: %s\n", IMG_GetError());
+            LOG_ERROR("Could not load pitch texture: %s", IMG_GetError());
             return false;
         }
 
           // Load elements texture (chứa cầu môn)
 
-        elementsTex = IMG_LoadTexture(renderer, "../kenney_sports-pack/PNG/Elements/element (41).png");
+        elementsTex = load_goal_texture();
         if(!elementsTex){
-            printf("Warning: Elements texture not found\n");
+            LOG_WARN("Elements texture not found");
         }
+        if(svgArt) LOG_INFO("SVG art: %d from cache, %d rasterized", svg.hits, svg.misses);
 
-        font = TTF_OpenFont("./build/OpenSans-Regular.ttf", 22);
-        if(!font){
-            // try relative
-            font = TTF_OpenFont("./OpenSans-Regular.ttf", 22);
-            if(!font) printf("Warning: could not open font, text rendering may fail\n");
+        if(!open_fonts("./build/OpenSans-Regular.ttf") && !open_fonts("./OpenSans-Regular.ttf")){
+            LOG_WARN("Could not open font, text rendering may fail");
         }
 
-        font_small = TTF_OpenFont("./build/OpenSans-Regular.ttf", 16);
-        if(!font_small){
-            font_small = TTF_OpenFont("./OpenSans-Regular.ttf", 16);
-            if(!font_small) printf("Warning: could not open small font\n");
-        }
+        setup_match();
+
+        // Áo đấu: chỉ nạp bộ đang dùng, texture gán lại mỗi frame qua bind_kits()
+        kits.load = [this](const char* path){ return load_texture(path); };
+        kits.release = [this](SDL_Texture* t){ destroy_texture(t); };
+        set_team_kit(Team::Blue, homeKit);
+        set_team_kit(Team::Red, awayKit);
+        bind_kits();
 
-        font_large = TTF_OpenFont("./build/OpenSans-Regular.ttf", 72);
-        if(!font_large){
-            font_large = TTF_OpenFont("./OpenSans-Regular.ttf", 72);
-            if(!font_large) printf("Warning: could not open large font\n");
+        build_static_background();
+
+        if(hotReload){
+            for(const char* path : { GRASS_SHEET_PNG, GRASS_SHEET_SVG, ELEMENTS_SVG }) assetWatch.watch(path);
+            if(!fontPath.empty()) assetWatch.watch(fontPath);
+            if(!aiTreePath.empty()) assetWatch.watch(aiTreePath);
+            assetWatch.start();
+            LOG_INFO("Hot reload: watching %zu textures", texturePaths.size());
         }
+        return true;
+    }
+
+    // Bóng + đội hình ban đầu (không cần renderer: --scenario chạy headless)
+    void setup_match(){
+        ball.size = 20;
+        aiBlackboard.clear();
+        lastTouchTeam = -1;
 
         // init players: simple config: left two players (team left), right two players (team right)
         players.clear();
@@ -609,62 +1056,61 @@ struct Game {
         p8.active = false; p8.isAI = aiEnabled;
         p8.team = Team::Red;
         players.push_back(p8);
+        playerTrails.assign(players.size(), Trail<PLAYER_TRAIL_LEN>());
+    }
 
-        // Blue
-        SDL_Texture *bodyBlue = IMG_LoadTexture(renderer, "../kenney_sports-pack/PNG/Blue/characterBlue (1).png");
-        SDL_Texture *armBlue  = IMG_LoadTexture(renderer, "../kenney_sports-pack/PNG/Blue/characterBlue (11).png");
-        SDL_Texture *legBlue  = IMG_LoadTexture(renderer, "../kenney_sports-pack/PNG/Blue/characterBlue (13).png");
-
-        // Red (nếu pack của bạn có thư mục Red, còn không thì dùng lại Blue)
-        SDL_Texture *bodyRed = IMG_LoadTexture(renderer, "../kenney_sports-pack/PNG/Red/characterRed (1).png");
-        SDL_Texture *armRed  = IMG_LoadTexture(renderer, "../kenney_sports-pack/PNG/Red/characterRed (11).png");
-        SDL_Texture *legRed  = IMG_LoadTexture(renderer, "../kenney_sports-pack/PNG/Red/characterRed (13).png");
-
-        if(!bodyBlue || !armBlue || !legBlue){
-            printf("Error loading Blue textures: %s\n", IMG_GetError());
-        }
-        if(!bodyRed || !armRed || !legRed){
-            // fallback: dùng Blue thay Red nếu thiếu
-            bodyRed = bodyBlue; armRed = armBlue; legRed = legBlue;
-        }
-
-        // Gán textures cho từng player
-        for(int i = 0; i < 4; i++){ // Blue team (0,1,2,3)
-            players[i].texBody = bodyBlue;
-            players[i].texArm = armBlue;
-            players[i].texLeg = legBlue;
-        }
-        for(int i = 4; i < 8; i++){ // Red team (4,5,6,7)
-            players[i].texBody = bodyRed;
-            players[i].texArm = armRed;
-            players[i].texLeg = legRed;
+    // Software path: dựng sẵn lớp nền tĩnh để khôi phục từng vùng bẩn
+    void build_static_background(){
+        if(!softwareRender || cpuRaster) return;
+        if(!staticTex) staticTex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, SCREEN_W, SCREEN_H);
+        if(staticTex && SDL_SetRenderTarget(renderer, staticTex) == 0){
+            draw_background(canvas);
+            SDL_SetRenderTarget(renderer, nullptr);
+        } else {
+            LOG_WARN("Could not cache background (%s), software path redraws it per rect", SDL_GetError());
+            if(staticTex) SDL_DestroyTexture(staticTex);
+            staticTex = nullptr;
         }
-
-        return true;
+        fullRepaint = true;
     }
 
+    // Phím đang giữ: bàn phím thật, hoặc phím do scenario giữ (--scenario)
+    const Uint8* keyboard() const { return scriptedKeys ? scriptedKeys : SDL_GetKeyboardState(NULL); }
+
     void handle_input(){
         SDL_Event e;
-        const Uint8* keystate = SDL_GetKeyboardState(NULL);
-        
-        // Handle kick input for each player
-        for(auto &p : players){
-            if(p.active && !p.isAI && keystate[p.kick]){
-                p.kickBall(ball);
-            }
-        }
-        
+        events.clear(); // frame mới
+        handle_kicks(keyboard());
+
         while(SDL_PollEvent(&e)){
             if(e.type == SDL_QUIT) running = false;
+            else if(e.type == SDL_WINDOWEVENT){
+                // nội dung cửa sổ có thể đã mất -> vẽ lại dù state không đổi
+                if(e.window.event == SDL_WINDOWEVENT_EXPOSED || e.window.event == SDL_WINDOWEVENT_SHOWN ||
+                   e.window.event == SDL_WINDOWEVENT_RESTORED || e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED){
+                    forceRedraw = true;
+                }
+            }
             else if(e.type == SDL_KEYDOWN){
+                if(!e.key.repeat && !pendingInputTicks) pendingInputTicks = e.key.timestamp ? e.key.timestamp : SDL_GetTicks();
                 if(e.key.keysym.scancode == SDL_SCANCODE_ESCAPE) running = false;
-                if(e.key.keysym.scancode == SDL_SCANCODE_F1) showDebug = !showDebug;
+                if(e.key.keysym.scancode == SDL_SCANCODE_F1){
+                    showDebug = !showDebug;
+                    for(auto &t : playerTrails) t.clear();
+                }
+                if(e.key.keysym.scancode == SDL_SCANCODE_F3) debugDraw.toggle(DBG_HITBOX);
+                if(e.key.keysym.scancode == SDL_SCANCODE_F4) debugDraw.toggle(DBG_KICK);
+                if(e.key.keysym.scancode == SDL_SCANCODE_F5) debugDraw.toggle(DBG_VELOCITY);
+                if(e.key.keysym.scancode == SDL_SCANCODE_F6) debugDraw.toggle(DBG_AI);
+                if(e.key.keysym.scancode == SDL_SCANCODE_F9) debugDraw.toggle(DBG_ASSIST);
+                if(e.key.keysym.scancode == SDL_SCANCODE_F7) cycle_kit(Team::Blue);
+                if(e.key.keysym.scancode == SDL_SCANCODE_F8) cycle_kit(Team::Red);
                 if(e.key.keysym.scancode == SDL_SCANCODE_F2){ 
                     aiEnabled = !aiEnabled; 
                     players[7].isAI = aiEnabled; // player thứ 4 (index 3)
 
                     autoSelectEnabled = !autoSelectEnabled;
-                    printf("Auto-select %s\n", autoSelectEnabled ? "ENABLED" : "DISABLED");
+                    LOG_INFO("Auto-select %s", autoSelectEnabled ? "ENABLED" : "DISABLED");
                 }
                 // Team switching: Q+Tab for Left team, P+Tab for Right team
                 if (!autoSelectEnabled) {
@@ -693,6 +1139,22 @@ struct Game {
         }
     }
 
+    // Handle kick input for each player
+    void handle_kicks(const Uint8* keystate){
+        for(auto &p : players){
+            if(p.active && !p.isAI && keystate[p.kick]) try_kick(p);
+        }
+    }
+
+    void try_kick(const Player& p){
+        if(!p.kickBall(ball)) return;
+        float bx = ball.x + ball.size/2.0f, by = ball.y + ball.size/2.0f;
+        float dx = bx - (p.r.x + p.r.w/2.0f), dy = by - (p.r.y + p.r.h/2.0f);
+        float len = std::sqrt(dx*dx + dy*dy);
+        if(len > 0.0001f){ dx /= len; dy /= len; }
+        events.push(SimEventType::Kick, bx, by, dx, dy, (int)p.team);
+    }
+
     void activate_only(int idx){
         for(size_t i=0;i<players.size();++i) players[i].active = (int)i==idx;
     }
@@ -761,6 +1223,7 @@ struct Game {
         // Cooldown để tránh đổi quá nhanh
         autoSelectCooldown -= dt;
         if(autoSelectCooldown > 0.0f) return;
+        if(worldIdle) return; // không ai/không gì di chuyển -> cầu thủ gần nhất không đổi
         
         // Tìm player gần nhất cho Blue team
         int closestBlue = findClosestPlayerInTeam(Team::Blue, ball);
@@ -788,35 +1251,28 @@ struct Game {
         }
     }
 
-        void update(float dt){
-        const Uint8* keystate = SDL_GetKeyboardState(NULL);
-
-        autoSelectPlayers(dt);
-        
-        // keyboard update for players
-        for(auto &p : players) p.update_from_keyboard(keystate, dt);
-        // AI update
-        for(auto &p : players) if(p.isAI) p.update_AI(ball, dt);
-
-        if(goalMessageTimer > 0.0f){
-            goalMessageTimer -= dt;
-        }
-
-        // ball physics
+    // Vật lý bóng: tích phân, tường, va chạm cầu thủ, ghi bàn
+    void update_ball(float dt){
+        const float ballR = ball.size / 2.0f;
+        const float prevBallCX = ball.x + ballR;
+        const float prevBallCY = ball.y + ballR;
         ball.update(dt);
 
-        // collision with top/bottom -> reflect
-        if(ball.y <= 0){ ball.y = 0; ball.vy = -ball.vy; }
-        if(ball.y + ball.size >= SCREEN_H){ ball.y = SCREEN_H - ball.size; ball.vy = -ball.vy; }
-
-        // collision with left/right -> reflect
-        if (ball.x <= 0) {
-            ball.x = 0;
-            ball.vx = -ball.vx;
-        }
-        if (ball.x + ball.size >= SCREEN_W) {
-            ball.x = SCREEN_W - ball.size;
-            ball.vx = -ball.vx;
+        // collision with walls -> reflect along the distance-field normal
+        // (2 passes so a ball wedged in a corner is pushed off both walls)
+        const PitchField& field = pitch_field();
+        for (int pass = 0; pass < 2; ++pass) {
+            FieldSample w = field.wall(ball.x + ballR, ball.y + ballR);
+            if (w.dist > ballR) break;
+            float push = ballR - w.dist;
+            ball.x += w.nx * push;
+            ball.y += w.ny * push;
+            float vn = ball.vx * w.nx + ball.vy * w.ny;
+            if (vn < 0.0f) {
+                ball.vx -= 2.0f * vn * w.nx;
+                ball.vy -= 2.0f * vn * w.ny;
+                events.push(SimEventType::WallBounce, ball.x + ballR, ball.y + ballR, w.nx, w.ny);
+            }
         }
         // collision with players
         SDL_Rect brect = ball.rect();
@@ -844,52 +1300,461 @@ struct Game {
                     ball.x = playerCenterX + dx * minDist - ball.size/2.0f;
                     ball.y = playerCenterY + dy * minDist - ball.size/2.0f;
                 }
+                events.push(SimEventType::PlayerBounce, ball.x + ballR, ball.y + ballR, dx, dy, (int)p.team);
 
                 reflect_ball_off_player(ball, p.r);
+                ball.wake();
                 break;
             }
         }
 
-        float scale = 0.8f;
-        int goalWidth  = SCREEN_W * 0.108 * scale;   // giảm cả width
-        int goalHeight = SCREEN_H * 0.15 * scale;    // giảm cả height
+        // --- Ghi bàn: bóng vượt qua vạch cầu môn giữa hai cột dọc ---
+        // Chỉ kiểm tra khi bóng đủ gần miệng khung thành (tra distance field, O(1))
+        const float ballCX = ball.x + ballR, ballCY = ball.y + ballR;
+        const float travel = fabsf(ballCX - prevBallCX) + fabsf(ballCY - prevBallCY);
+        int goal = 0;
+        if (field.mouth(ballCX, ballCY).dist <= ballR + travel + PitchField::CELL) {
+            goal = goal_line_crossed(PITCH, prevBallCX, prevBallCY, ballCX, ballCY, ballR);
+        }
+        if (goal != 0) {
+            const GoalMouth& m = PITCH.goals[goal - 1];
+            events.push(SimEventType::Goal, m.lineX, clampf(ballCY, m.top, m.bottom), -m.inward, 0.0f,
+                        goal == 1 ? (int)Team::Red : (int)Team::Blue);
+        }
+        if (goal == 1) {          // goal trái
+            score.right += 1;     // đội phải ghi bàn
+            metrics.goalsRed.add();
+            goalMessageTimer = 1.5f;
+            ball.reset(false, rng); // giao bóng cho đội trái
+            ballTrail.clear();
+        } else if (goal == 2) {   // goal phải
+            score.left += 1;      // đội trái ghi bàn
+            metrics.goalsBlue.add();
+            goalMessageTimer = 1.5f;
+            ball.reset(true, rng);  // giao bóng cho đội phải
+            ballTrail.clear();
+        }
+
+        // small friction to avoid runaway velocities
+        float maxSpeed = 900.0f;
+        float sp = std::sqrt(ball.vx*ball.vx + ball.vy*ball.vy);
+        if(sp > maxSpeed){ ball.vx *= maxSpeed/sp; ball.vy *= maxSpeed/sp; }
+    }
+
+    void update(float dt){
+        const Uint8* keystate = keyboard();
 
-        int goalCenterY = SCREEN_H / 2;  
-        int goalY = goalCenterY - goalHeight / 2;  // cập nhật lại Y
+        autoSelectPlayers(dt);
+        
+        // keyboard update for players
+        for(auto &p : players) p.update_from_keyboard(keystate, dt);
+        // AI update (replan lệch pha / theo sự kiện, xem aiSchedule)
+        if(policy) update_policy_players(dt);
+        else update_ai_players(dt);
+        ++aiTick;
 
-        // --- Ghi bàn bên trái (bóng lọt vào goal trái) ---
-        if (ball.x <= 80) { // bóng vượt qua vạch trong
-            if (ball.y + ball.size >= goalY && ball.y <= goalY + goalHeight) {
-                score.right += 1;     // đội phải ghi bàn
-                goalMessageTimer = 1.5f;
-                ball.reset(false);    // giao bóng cho đội trái
+        if(goalMessageTimer > 0.0f){
+            goalMessageTimer -= dt;
+        }
+
+        // Bóng ngủ và không ai di chuyển -> bỏ qua toàn bộ vật lý/va chạm
+        bool anyPlayerMoved = false;
+        for(const auto &p : players) if(!p.idle){ anyPlayerMoved = true; break; }
+        worldIdle = ball.sleeping && !anyPlayerMoved;
+        if(!worldIdle) update_ball(dt);
+
+
+        // trails: one sample per tick (ball trail follows the drawn sprite)
+        if(ball.sleeping) ballTrail.clear();
+        else ballTrail.push(ball.x + ball.size/2.0f - Ball::DRAW_OFFSET, ball.y + ball.size/2.0f - Ball::DRAW_OFFSET);
+        if(debug_trails_shown() && !worldIdle){
+            for(size_t i = 0; i < players.size(); ++i){
+                playerTrails[i].push(players[i].r.x + players[i].r.w/2.0f, players[i].r.y + players[i].r.h/2.0f);
             }
         }
 
-        // --- Ghi bàn bên phải (bóng lọt vào goal phải) ---
-        if (ball.x + ball.size >= SCREEN_W - 80) { // bóng vượt qua vạch trong
-            if (ball.y + ball.size >= goalY && ball.y <= goalY + goalHeight) {
-                score.left += 1;      // đội trái ghi bàn
-                goalMessageTimer = 1.5f;
-                ball.reset(true);     // giao bóng cho đội phải
+        // effects
+        particles.begin_frame();
+        particles.emit_from(events);
+        if(particles.count > 0) particles.update(dt);
+
+        schedule_ai_events();
+
+        if(recordPath) record_replay_frame(dt);
+        if(renderer) bind_kits();
+    }
+
+    // Sự kiện tick này làm kế hoạch của AI lỗi thời -> mọi AI replan ở tick sau:
+    // có người sút, bóng đổi sang chân đội kia, hoặc bàn thắng (giao bóng lại)
+    void schedule_ai_events(){
+        bool replan = false;
+        for(const SimEvent& e : events){
+            if(e.type == SimEventType::Goal){ replan = true; lastTouchTeam = -1; }
+            if(e.type != SimEventType::Kick && e.type != SimEventType::PlayerBounce) continue;
+            replan |= e.type == SimEventType::Kick || e.team != lastTouchTeam;
+            lastTouchTeam = e.team;
+        }
+        if(replan) aiSchedule.request_all();
+    }
+
+    // Chu kỳ replan thực tế: aiReplanTicks, giãn ra khi quality hạ (không bao giờ ngắn hơn)
+    int ai_replan_period() const {
+        return std::max(aiReplanTicks, (int)lroundf(aiReplanTicks * quality.settings().aiReplanStretch));
+    }
+
+    // AI theo behavior tree: cây chạy lúc replan (aiSchedule: mỗi ai_replan_period() tick, lệch pha,
+    // sớm hơn khi có sự kiện, trong ngân sách --ai-budget-us), mỗi tick đi tới mục tiêu đã đặt,
+    // vận tốc chỉnh qua ORCA để không chen vào nhau
+    void update_ai_players(float dt){
+        aiClock += dt;
+        int aiCount = 0;
+        for(const Player& p : players) aiCount += p.isAI;
+        if(aiCount == 0) return;
+        aiSchedule.period = ai_replan_period();
+        const uint64_t deferredBefore = aiSchedule.deferred;
+        int planned = aiSchedule.run(aiTick, players.size(), [&](size_t i){ return players[i].isAI; },
+                                     [&](size_t i){ plan_ai(i); });
+        metrics.aiPlans.add((uint64_t)planned);
+        if(aiSchedule.deferred != deferredBefore) metrics.aiDeferred.add(aiSchedule.deferred - deferredBefore);
+
+        // Mọi cầu thủ vào crowd; người chơi không né (AI né họ hoàn toàn)
+        crowd.clear();
+        for(const Player& p : players){
+            CrowdAgent a = {};
+            a.x = p.r.x + p.r.w/2.0f;
+            a.y = p.r.y + p.r.h/2.0f;
+            a.radius = AVOID_RADIUS;
+            a.reactive = p.isAI;
+            if(p.isAI){
+                p.ai_preferred_velocity(a.prefVx, a.prefVy);
+                a.vx = p.aiVx; a.vy = p.aiVy;
+                a.maxSpeed = std::max(std::sqrt(a.prefVx*a.prefVx + a.prefVy*a.prefVy), p.speed * p.aiUrgency);
+            } else if(!p.idle){
+                a.vx = p.moveX * p.speed; a.vy = p.moveY * p.speed;
             }
+            crowd.add(a);
+        }
+        if(avoidance) crowd.solve(dt);
+
+        for(size_t i = 0; i < players.size(); ++i){
+            Player& p = players[i];
+            if(!p.isAI) continue;
+            const CrowdAgent& a = crowd.agents[i];
+            p.aiVx = avoidance ? crowd.outVx[i] : a.prefVx;
+            p.aiVy = avoidance ? crowd.outVy[i] : a.prefVy;
+            p.move_velocity(p.aiVx, p.aiVy, dt);
+            if(p.aiKick){ p.aiKick = false; try_kick(p); }
         }
+    }
 
-        // small friction to avoid runaway velocities
-        float maxSpeed = 900.0f;
-        float sp = std::sqrt(ball.vx*ball.vx + ball.vy*ball.vy);
-        if(sp > maxSpeed){ ball.vx *= maxSpeed/sp; ball.vy *= maxSpeed/sp; }
+    void plan_ai(size_t i){
+        const size_t slots = (size_t)aiTree.slots;
+        if(aiBlackboard.size() != players.size() * slots) aiBlackboard.assign(players.size() * slots, 0.0f);
+        AiLeaves leaves{ *this, players[i] };
+        bt_tick(aiTree, aiBlackboard.data() + i * slots, aiClock, leaves);
+    }
+
+    // Cho lá pass_open / shot_open / aim_*: đánh giá khi cây cần, một lần mỗi đội mỗi tick
+    const PlayOptions& play_options(Team team){
+        const int t = team == Team::Blue ? 0 : 1;
+        if(playOptionsTick[t] != aiTick){
+            evaluate_play(team, playOptions[t]);
+            playOptionsTick[t] = aiTick;
+        }
+        return playOptions[t];
+    }
+
+    // Người giữ bóng của đội (gần bóng nhất) chuyền cho từng đồng đội / sút vào từng điểm trên
+    // khung thành: mọi đích chấm điểm trong một lượt qua các đối thủ (LaneEvaluator).
+    // Đội đông hơn giới hạn thì lấy các đồng đội / đối thủ gần bóng nhất
+    void evaluate_play(Team team, PlayOptions& out){
+        out = PlayOptions{};
+        const float bx = ball.x + ball.size/2.0f, by = ball.y + ball.size/2.0f;
+        auto dist2 = [&](const Player& q){
+            float dx = q.r.x + q.r.w/2.0f - bx, dy = q.r.y + q.r.h/2.0f - by;
+            return dx*dx + dy*dy;
+        };
+        auto nearest = [&](bool mates, int limit){
+            laneScratch.clear();
+            for(size_t i = 0; i < players.size(); ++i){
+                if((players[i].team == team) != mates || (int)i == out.carrier) continue;
+                laneScratch.push_back({ dist2(players[i]), (int)i });
+            }
+            if((int)laneScratch.size() > limit){
+                std::nth_element(laneScratch.begin(), laneScratch.begin() + limit, laneScratch.end());
+                laneScratch.resize(limit);
+            }
+        };
+
+        float carrierDist = INFINITY;
+        for(size_t i = 0; i < players.size(); ++i){
+            if(players[i].team != team) continue;
+            float d = dist2(players[i]);
+            if(d < carrierDist){ carrierDist = d; out.carrier = (int)i; }
+        }
+        if(out.carrier < 0) return;
+
+        lanes.clear();
+        nearest(true, PlayOptions::MAX_PASSES);
+        for(const auto &c : laneScratch){
+            const Player& q = players[c.second];
+            out.passTo[out.passCount++] = c.second;
+            lanes.add_target(q.r.x + q.r.w/2.0f, q.r.y + q.r.h/2.0f);
+        }
+        const GoalMouth& m = PITCH.goals[team == Team::Blue ? 1 : 0]; // khung thành đối phương
+        const float inset = ball.size/2.0f + 2.0f;
+        for(int k = 0; k < PlayOptions::SHOT_SAMPLES; ++k){
+            out.shotX[k] = m.lineX;
+            out.shotY[k] = m.top + inset + (m.height() - 2.0f * inset) * (k + 0.5f) / PlayOptions::SHOT_SAMPLES;
+            lanes.add_target(out.shotX[k], out.shotY[k]);
+        }
+        nearest(false, LaneEvaluator::MAX_OPPONENTS);
+        for(const auto &c : laneScratch){
+            const Player& q = players[c.second];
+            lanes.add_opponent(q.r.x + q.r.w/2.0f, q.r.y + q.r.h/2.0f);
+        }
+
+        lanes.evaluate(bx, by, lane_params());
+
+        for(int k = 0; k < out.passCount; ++k){
+            out.passScore[k] = LaneEvaluator::score(lanes.margin[k]);
+            if(out.bestPass < 0 || out.passScore[k] > out.passScore[out.bestPass]) out.bestPass = k;
+        }
+        int open = 0;
+        for(int k = 0; k < PlayOptions::SHOT_SAMPLES; ++k){
+            float margin = lanes.margin[out.passCount + k];
+            out.shotScore[k] = LaneEvaluator::score(margin);
+            open += margin > 0.0f;
+            if(out.bestShot < 0 || out.shotScore[k] > out.shotScore[out.bestShot]) out.bestShot = k;
+        }
+        out.shotWindow = open / (float)PlayOptions::SHOT_SAMPLES;
+    }
+
+    // Theo vật lý hiện tại: lực sút của kickBall, ma sát của Ball, tốc độ cầu thủ
+    static const LaneParams& lane_params(){
+        static const LaneParams lp = []{
+            LaneParams l;
+            l.kickSpeed = Player::KICK_FORCE;
+            l.decay = -std::log(Ball::FRICTION_PER_SEC) * 60.0f;
+            l.runSpeed = Player().speed;
+            l.reach = Player::BODY_H / 2.0f + 10.0f; // nửa thân + bán kính bóng
+            return l;
+        }();
+        return lp;
+    }
+
+    // Biên dịch file cây; lỗi thì giữ cây đang chạy
+    bool load_ai_tree(const std::string& path){
+        BtProgram prog;
+        std::string err;
+        if(!prog.load(path.c_str(), AI_LEAVES, AI_LEAF_COUNT, err)){
+            LOG_ERROR("AI tree: %s", err);
+            return false;
+        }
+        aiTree = std::move(prog);
+        aiTreePath = path;
+        aiBlackboard.clear();
+        LOG_INFO("AI tree %s: %zu nodes, %d blackboard slots", path, aiTree.code.size(), aiTree.slots);
+        return true;
+    }
+
+    // Mọi cầu thủ AI của trận qua policy trong một lần forward
+    void update_policy_players(float dt){
+        policyPlayers.clear();
+        for(size_t i = 0; i < players.size(); ++i) if(players[i].isAI) policyPlayers.push_back((int)i);
+        if(policyPlayers.empty()) return;
+        const int n = (int)policyPlayers.size();
+        policyIn.resize((size_t)n * POLICY_INPUTS);
+        policyOut.resize((size_t)n * POLICY_OUTPUTS);
+        for(int k = 0; k < n; ++k) policy_features(players[policyPlayers[k]], &policyIn[(size_t)k * POLICY_INPUTS]);
+        policy->forward(policyIn.data(), n, policyOut.data());
+        for(int k = 0; k < n; ++k){
+            Player& p = players[policyPlayers[k]];
+            int dx, dy;
+            bool kick;
+            policy_decode(p, &policyOut[(size_t)k * POLICY_OUTPUTS], dx, dy, kick);
+            p.move(dx, dy, dt);
+            if(kick) try_kick(p);
+        }
+    }
+
+    // Đặc trưng nhìn từ phía đội của p (đội cam lật trục x, nên policy luôn tấn công sang phải):
+    // bản thân, bóng, vận tốc bóng, bóng - bản thân, 3 đồng đội, 4 đối thủ; chuẩn hoá về ~[-1, 1]
+    void policy_features(const Player& p, float* f) const {
+        const bool flip = p.team == Team::Red;
+        auto fx = [&](float x){ return ((flip ? SCREEN_W - x : x) - SCREEN_W * 0.5f) / (SCREEN_W * 0.5f); };
+        auto fy = [&](float y){ return (y - SCREEN_H * 0.5f) / (SCREEN_H * 0.5f); };
+        const float px = p.r.x + p.r.w/2.0f, py = p.r.y + p.r.h/2.0f;
+        const float bx = ball.x + ball.size/2.0f, by = ball.y + ball.size/2.0f;
+        *f++ = fx(px); *f++ = fy(py);
+        *f++ = fx(bx); *f++ = fy(by);
+        *f++ = (flip ? -ball.vx : ball.vx) / 900.0f; *f++ = ball.vy / 900.0f;
+        *f++ = (flip ? px - bx : bx - px) / (SCREEN_W * 0.5f); *f++ = (by - py) / (SCREEN_H * 0.5f);
+        int mates = 0, opponents = 0;
+        float* mate = f;
+        float* opp = f + 6;
+        for(const Player& q : players){
+            if(&q == &p) continue;
+            float qx = fx(q.r.x + q.r.w/2.0f), qy = fy(q.r.y + q.r.h/2.0f);
+            if(q.team == p.team && mates < 3){ mate[mates*2] = qx; mate[mates*2 + 1] = qy; ++mates; }
+            else if(q.team != p.team && opponents < 4){ opp[opponents*2] = qx; opp[opponents*2 + 1] = qy; ++opponents; }
+        }
+        for(; mates < 3; ++mates){ mate[mates*2] = 0.0f; mate[mates*2 + 1] = 0.0f; }
+        for(; opponents < 4; ++opponents){ opp[opponents*2] = 0.0f; opp[opponents*2 + 1] = 0.0f; }
+    }
+
+    // Đầu ra: hướng x, hướng y (vùng chết ±1/3), logit sút (> 0 = sút)
+    static void policy_decode(const Player& p, const float* out, int& dx, int& dy, bool& kick){
+        auto axis = [](float v){ return v > 0.33f ? 1 : (v < -0.33f ? -1 : 0); };
+        dx = axis(out[0]) * (p.team == Team::Red ? -1 : 1);
+        dy = axis(out[1]);
+        kick = out[2] > 0.0f;
+    }
+
+    void set_team_kit(Team team, int kit){
+        (team == Team::Blue ? homeKit : awayKit) = kit;
+        for(auto &p : players) if(p.team == team) p.kit = kit;
+        forceRedraw = true; // áo / dòng "Kits:" không nằm trong visible_state_hash
+    }
+
+    // Lấy texture áo đấu cho frame này (nạp nếu chưa có, có thể evict bộ cũ). Đánh dấu mọi bộ
+    // đang mặc trước: nạp bộ mới của đội này không được evict bộ đội kia rồi lại nạp lại
+    void bind_kits(){
+        kits.begin_frame();
+        for(const auto &p : players) kits.touch(p.kit);
+        for(auto &p : players){
+            const KitTextures& k = kits.acquire(p.kit);
+            p.texBody = k.body; p.texArm = k.arm; p.texLeg = k.leg;
+        }
+    }
+
+    // Đổi sang bộ áo kế tiếp, bỏ qua bộ đội kia đang mặc
+    void cycle_kit(Team team){
+        int cur = team == Team::Blue ? homeKit : awayKit;
+        int other = team == Team::Blue ? awayKit : homeKit;
+        int next = (cur + 1) % KIT_COUNT;
+        if(next == other) next = (next + 1) % KIT_COUNT;
+        set_team_kit(team, next);
+        LOG_INFO("%s team kit: %s", team == Team::Blue ? "Blue" : "Orange", KITS[next].name);
+    }
+
+    // Vệt debug (F3) chỉ hiện khi mức chất lượng còn cho phép
+    bool debug_trails_shown() const { return showDebug && quality.settings().debugOverlays; }
+
+    void apply_quality(){
+        const QualitySettings& q = quality.settings();
+        particles.budget = std::max(1, (int)(ParticlePool::DEFAULT_BUDGET * q.particleScale));
+        metrics.qualityLevel.set(quality.level);
+        forceRedraw = true;
+    }
+
+    // Gọi sau mỗi frame được present: tickSec là thời gian update của frame đó
+    void govern(double tickSec){
+        Uint64 now = SDL_GetPerformanceCounter();
+        double interval = presentStreak ? (now - lastPresentAt) / (double)SDL_GetPerformanceFrequency() : 0.0;
+        lastPresentAt = now;
+        presentStreak = true;
+        if(!quality.observe((float)interval, (float)(tickSec + renderWork))) return;
+        apply_quality();
+        LOG_INFO("Quality: %s (frame %.1fms, work %.1fms)", quality.settings().name,
+                 quality.interval * 1000.0f, quality.work * 1000.0f);
+    }
+
+    // Ghi keyframe replay với tần số cố định (--record)
+    void record_replay_frame(float dt){
+        matchTime += dt;
+        if(matchTime < nextSnapshotTime) return;
+        nextSnapshotTime = matchTime + 1.0f / Replay::RECORD_HZ;
+
+        ReplayFrame f{};
+        f.time = matchTime;
+        f.ballX = ball.x;
+        f.ballY = ball.y;
+        f.ballAngle = ball.angle;
+        f.scoreLeft = (uint8_t)score.left;
+        f.scoreRight = (uint8_t)score.right;
+        f.playerCount = (uint8_t)std::min<size_t>(players.size(), ReplayFrame::MAX_PLAYERS);
+        for(int i = 0; i < f.playerCount; ++i){
+            const Player& p = players[i];
+            f.players[i] = { p.visX, p.visY, p.moveX, p.moveY, p.animTime, (uint8_t)p.active };
+        }
+        replay.frames.push_back(f);
     }
 
     // Hàm vẽ cầu môn từ elements.png (dùng toàn bộ ảnh, không cắt sprite)
-    void render_goal(int x, int y, int width, int height, bool leftGoal = true){
+    void render_goal(Canvas& c, const GoalMouth& goal, bool leftGoal = true){
         if(!elementsTex) return;
         // Không dùng srcRect (NULL = lấy toàn bộ ảnh)
-        SDL_Rect dstGoal = {x, y, 60, 100};
+        SDL_Rect dstGoal = {(int)goal.sprite.x, (int)goal.sprite.y, (int)goal.sprite.w, (int)goal.sprite.h};
 
         // Nếu muốn lật cho cầu môn bên phải
         SDL_RendererFlip flip = leftGoal ? SDL_FLIP_NONE : SDL_FLIP_HORIZONTAL;
-        SDL_RenderCopyEx(renderer, elementsTex, NULL, &dstGoal, 0, NULL, flip);
+        c.copy_ex(elementsTex, NULL, &dstGoal, 0, NULL, flip);
+    }
+
+    // Vòng tròn đặc (triangle fan)
+    void fill_circle(float cx, float cy, float radius, SDL_Color c){
+        constexpr int SEG = 32;
+        SDL_Vertex v[SEG + 1];
+        int idx[SEG * 3];
+        v[0] = { { cx, cy }, c, { 0, 0 } };
+        for(int i = 0; i < SEG; ++i){
+            float a = i * 2.0f * (float)M_PI / SEG;
+            v[i + 1] = { { cx + radius * cosf(a), cy + radius * sinf(a) }, c, { 0, 0 } };
+            idx[i*3] = 0; idx[i*3 + 1] = i + 1; idx[i*3 + 2] = (i + 1) % SEG + 1;
+        }
+        canvas.geometry(v, SEG + 1, idx, SEG * 3);
+    }
+
+    // Gom hình học debug của frame (không tốn gì khi tắt hết category)
+    void queue_debug_geometry(){
+        if(!debugDraw.enabled) return;
+        // trợ giúp người chơi không phải debug: vẫn vẽ khi quality tắt debug overlay
+        if(debugDraw.on(DBG_ASSIST)){ queue_assist(Team::Blue); queue_assist(Team::Red); }
+        if(!quality.settings().debugOverlays) return;
+        const SDL_Color yellow = {255, 235, 80, 220};
+        const SDL_Color cyan   = {80, 230, 255, 220};
+        const SDL_Color red    = {255, 70, 70, 230};
+        const SDL_Color white  = {255, 255, 255, 200};
+
+        for(const auto &p : players){
+            float cx = p.r.x + p.r.w/2.0f, cy = p.r.y + p.r.h/2.0f;
+            debugDraw.rect(DBG_HITBOX, (float)p.r.x, (float)p.r.y, (float)p.r.w, (float)p.r.h, yellow);
+            debugDraw.circle(DBG_KICK, cx, cy, p.kickRange, p.canKickBall(ball) ? red : white);
+            debugDraw.arrow(DBG_VELOCITY, cx, cy, cx + p.moveX * p.speed * 0.2f, cy + p.moveY * p.speed * 0.2f, cyan);
+            if(p.isAI){
+                debugDraw.line(DBG_AI, cx, cy, p.aiTargetX, p.aiTargetY, red);
+                debugDraw.cross(DBG_AI, p.aiTargetX, p.aiTargetY, 5.0f, red);
+            }
+        }
+        float bx = ball.x + ball.size/2.0f, by = ball.y + ball.size/2.0f;
+        debugDraw.rect(DBG_HITBOX, ball.x, ball.y, (float)ball.size, (float)ball.size, white);
+        debugDraw.arrow(DBG_VELOCITY, bx, by, bx + ball.vx * 0.2f, by + ball.vy * 0.2f, white); // vị trí sau 0.2s
+        for(const GoalMouth &m : PITCH.goals){
+            debugDraw.line(DBG_HITBOX, m.lineX, m.top, m.lineX, m.bottom, red, 2.0f);
+        }
+    }
+
+    // Trợ giúp người chơi (F9): khi cầu thủ đang điều khiển giữ bóng, vẽ đường chuyền tới từng đồng
+    // đội và các điểm trên khung thành, đỏ (bị cắt) -> xanh (an toàn); lựa chọn tốt nhất vẽ đậm
+    void queue_assist(Team team){
+        PlayOptions o;
+        evaluate_play(team, o);
+        if(o.carrier < 0 || !players[o.carrier].active || players[o.carrier].isAI) return;
+        auto shade = [](float score){
+            return SDL_Color{ (Uint8)(255 - 175 * score), (Uint8)(70 + 160 * score), (Uint8)(70 + 50 * score), 230 };
+        };
+        const float bx = ball.x + ball.size/2.0f, by = ball.y + ball.size/2.0f;
+        for(int k = 0; k < o.passCount; ++k){
+            const Player& q = players[o.passTo[k]];
+            debugDraw.line(DBG_ASSIST, bx, by, q.r.x + q.r.w/2.0f, q.r.y + q.r.h/2.0f, shade(o.passScore[k]), k == o.bestPass ? 3.0f : 1.5f);
+        }
+        for(int k = 0; k < PlayOptions::SHOT_SAMPLES; ++k){
+            debugDraw.cross(DBG_ASSIST, o.shotX[k], o.shotY[k], 4.0f, shade(o.shotScore[k]));
+        }
+        if(o.bestShot >= 0 && o.shotScore[o.bestShot] > 0.0f){
+            debugDraw.line(DBG_ASSIST, bx, by, o.shotX[o.bestShot], o.shotY[o.bestShot], shade(o.shotScore[o.bestShot]), 2.0f);
+        }
     }
 
     void render_text(const std::string &txt, int x, int y){
@@ -936,109 +1801,548 @@ struct Game {
         if(tex){SDL_RenderCopy(renderer, tex, NULL, &dst);SDL_DestroyTexture(tex);}
     }
 
-    void render(){
-        // background
-        SDL_RenderClear(renderer);
+    // ===== Draw items: mọi thứ vẽ trên nền, theo đúng thứ tự lớp =====
+    // Dùng chung cho vẽ full (GPU) và vẽ từng vùng bẩn (software renderer).
+    enum DrawKind : uint8_t { DRAW_PLAYER, DRAW_TRAILS, DRAW_BALL, DRAW_GOAL, DRAW_PARTICLES, DRAW_DEBUG_GEOMETRY, DRAW_HUD };
+    enum HudItem  : uint8_t { HUD_TITLE, HUD_CONTROLS, HUD_SWITCH, HUD_AUTOSELECT, HUD_SCORE, HUD_GOAL, HUD_DEBUG, HUD_COUNT };
 
-        if(bgTex){
-            SDL_Rect dst = {0, 0, SCREEN_W, SCREEN_H};
-            SDL_RenderCopy(renderer, bgTex, NULL, &dst);
+    struct DrawItem {
+        DrawKind kind;
+        int index;
+        SDL_Rect bounds;  // mọi pixel item vẽ đều nằm trong đây (w = 0: không hiện)
+        uint64_t hash;    // đổi khi nội dung item đổi
+    };
+
+    static constexpr int MAX_DRAW_ITEMS = 64;
+    DrawItem drawItems[MAX_DRAW_ITEMS];
+    DrawItem prevDrawItems[MAX_DRAW_ITEMS];
+    int drawItemCount = 0, prevDrawItemCount = 0;
+    uint64_t frameCounter = 0;
+
+    // Software path: vẽ thẳng lên window surface, chỉ cập nhật vùng bẩn
+    bool softwareRender = false;
+    SDL_Texture* staticTex = nullptr; // nền + vạch giữa sân, đã dựng sẵn ở độ phân giải màn hình
+    bool fullRepaint = true;
+    DirtyRects dirty;
+
+    // CPU raster path (--cpu-raster): tự rasterize sprite trên CPU, đa luồng
+    bool cpuRaster = false;
+    CpuRenderer cpu;
+    std::unique_ptr<ThreadPool> workers;
+    Canvas canvas; // nơi draw_item vẽ vào: SDL_Renderer hoặc draw list của cpu
+
+    // Replay: --record ghi keyframe khi chơi, --export dựng lại thành video
+    Replay replay;
+    const char* recordPath = nullptr;
+    float matchTime = 0.0f, nextSnapshotTime = 0.0f;
+    bool hiddenWindow = false; // export chạy không cần hiện cửa sổ
+
+    // --svg-art: sân và cầu môn rasterize từ Vector/*.svg đúng độ phân giải ra, cache trên đĩa
+    bool svgArt = false;
+    float artScale = 0.0f; // pixel ra / đơn vị màn hình; 0 = theo renderer
+    SvgCache svg;
+
+    // --hot-reload: file ảnh/font đổi trên đĩa → decode lại trên luồng riêng, vá vào texture đang dùng
+    bool hotReload = false;
+    AssetWatcher assetWatch;
+    std::unordered_map<std::string, SDL_Texture*> texturePaths; // texture nạp qua load_texture
+    std::string fontPath;
+    static constexpr const char* GRASS_SHEET_PNG = "../kenney_sports-pack/Tilesheet/groundGrass_mownWide.png";
+    static constexpr const char* GRASS_SHEET_SVG = "../kenney_sports-pack/Vector/groundGrass_mownWide_vector.svg";
+    static constexpr const char* ELEMENTS_SVG    = "../kenney_sports-pack/Vector/elements.svg";
+
+    static SDL_Rect bounds_around(float cx, float cy, float radius){
+        return { (int)std::floor(cx - radius), (int)std::floor(cy - radius), (int)std::ceil(radius * 2) + 1, (int)std::ceil(radius * 2) + 1 };
+    }
+
+    static void grow(SDL_Rect& acc, const SDL_Rect& r){
+        if(r.w <= 0 || r.h <= 0) return;
+        if(acc.w <= 0 || acc.h <= 0){ acc = r; return; }
+        SDL_Rect u; SDL_UnionRect(&acc, &r, &u); acc = u;
+    }
+
+    template<int N>
+    static void grow_trail(SDL_Rect& acc, const Trail<N>& t, float pad){
+        for(int k = 0; k < t.count; ++k){
+            const SDL_FPoint& p = t.at(k);
+            grow(acc, bounds_around(p.x, p.y, pad));
         }
-        // mid line
-        SDL_SetRenderDrawColor(renderer, 200,200,200,120);
-        SDL_Rect mid = {SCREEN_W/2 - 2, 0, 4, SCREEN_H};
-        SDL_RenderFillRect(renderer, &mid);
+    }
+
+    bool kick_range_shown(const Player& p) const { return p.active && p.canKickBall(ball); }
 
-        // draw players with kick range indicator
+    void push_item(DrawKind kind, int index, SDL_Rect bounds, uint64_t hash){
+        if(drawItemCount < MAX_DRAW_ITEMS) drawItems[drawItemCount++] = { kind, index, bounds, hash };
+    }
+
+    void collect_draw_items(){
+        drawItemCount = 0;
+        ++frameCounter;
+
+        for(size_t i = 0; i < players.size(); ++i){
+            const Player& p = players[i];
+            Fnv1a h;
+            h.add(p.visX); h.add(p.visY); h.add(p.moveX); h.add(p.moveY); h.add(p.animTime);
+            h.add(p.active); h.add(p.texBody); h.add(p.jerseyTint);
+            float cx = std::round(p.visX) + Player::BODY_W * 0.5f;
+            float cy = std::round(p.visY) + Player::BODY_H * 0.5f;
+            SDL_Rect b = bounds_around(cx, cy, Player::BODY_H + 8.0f); // thân + tay chân + viền
+            bool kick = kick_range_shown(p);
+            h.add(kick);
+            if(kick){
+                h.add(p.r);
+                grow(b, bounds_around(p.r.x + p.r.w/2.0f, p.r.y + p.r.h/2.0f, p.kickRange + 1.0f));
+            }
+            push_item(DRAW_PLAYER, (int)i, b, h.value());
+        }
+
+        {
+            Fnv1a h;
+            SDL_Rect b = {0, 0, 0, 0};
+            h.add(ballTrail.head); h.add(ballTrail.count);
+            if(ballTrail.count > 0) h.add(ballTrail.at(ballTrail.count - 1));
+            grow_trail(b, ballTrail, ball.size * 0.3f + 2.0f);
+            h.add(debug_trails_shown());
+            if(debug_trails_shown()){
+                for(const auto &t : playerTrails){
+                    h.add(t.head); h.add(t.count);
+                    grow_trail(b, t, 3.0f);
+                }
+            }
+            push_item(DRAW_TRAILS, 0, b, h.value());
+        }
+
+        {
+            SDL_Rect brect = ball.rect();
+            brect.x -= Ball::DRAW_OFFSET;
+            brect.y -= Ball::DRAW_OFFSET;
+            Fnv1a h;
+            h.add(brect); h.add(ball.angle);
+            // sprite xoay: mở rộng theo đường chéo
+            SDL_Rect b = bounds_around(brect.x + brect.w/2.0f, brect.y + brect.h/2.0f, brect.w * 0.72f + 1.0f);
+            push_item(DRAW_BALL, 0, b, h.value());
+        }
+
+        for(int g = 0; g < 2; ++g){
+            const PitchRect& sp = PITCH.goals[g].sprite;
+            push_item(DRAW_GOAL, g, { (int)sp.x, (int)sp.y, (int)sp.w, (int)sp.h }, 0);
+        }
+
+        {
+            SDL_Rect b = {0, 0, 0, 0};
+            for(int i = 0; i < particles.count; ++i){
+                grow(b, bounds_around(particles.x[i], particles.y[i], particles.size[i] * 0.5f + 1.0f));
+            }
+            push_item(DRAW_PARTICLES, 0, b, particles.count > 0 ? frameCounter : 0);
+        }
+
+        {
+            SDL_Rect b = debugDraw.enabled ? SDL_Rect{0, 0, SCREEN_W, SCREEN_H} : SDL_Rect{0, 0, 0, 0};
+            push_item(DRAW_DEBUG_GEOMETRY, 0, b, debugDraw.enabled ? frameCounter : 0);
+        }
+
+        for(int i = 0; i < HUD_COUNT; ++i){
+            char buf[64];
+            const char* txt = hud_text(i, buf, sizeof(buf));
+            Fnv1a h;
+            if(txt) h.add(txt, strlen(txt));
+            if(i == HUD_DEBUG && showDebug) h.add(frameCounter); // số liệu đổi mỗi frame
+            push_item(DRAW_HUD, i, hud_bounds(i, txt), h.value());
+        }
+    }
+
+    // Nội dung chữ của HUD (nullptr = không hiện)
+    const char* hud_text(int idx, char* buf, size_t n) const {
+        switch(idx){
+            case HUD_TITLE:      return "Tiny Football";
+            case HUD_CONTROLS:   return "Controls: WASD+Q (Blue Team), Arrows+Enter (Orange Team)";
+            case HUD_SWITCH:     return "Switch Player: Q+Tab (Blue), P+RShift (Orange)";
+            case HUD_AUTOSELECT: return autoSelectEnabled ? "AUTO-SELECT: ON" : "AUTO-SELECT: OFF";
+            case HUD_SCORE:      snprintf(buf, n, "%d  -  %d", score.left, score.right); return buf;
+            case HUD_GOAL:       return (goalMessageTimer > 0.0f && font_large) ? "GOAL!!!" : nullptr;
+            case HUD_DEBUG:      return showDebug ? "debug" : nullptr;
+        }
+        return nullptr;
+    }
+
+    SDL_Rect hud_bounds(int idx, const char* txt) const {
+        if(!txt) return {0, 0, 0, 0};
+        // đo đúng style lúc vẽ (bold rộng hơn normal)
+        auto text_rect = [](TTF_Font* f, const char* t, int x, int y, int pad, bool bold) -> SDL_Rect {
+            int w = 0, h = 0;
+            if(!f) return {0, 0, 0, 0};
+            if(bold) TTF_SetFontStyle(f, TTF_STYLE_BOLD);
+            int err = TTF_SizeText(f, t, &w, &h);
+            if(bold) TTF_SetFontStyle(f, TTF_STYLE_NORMAL);
+            if(err != 0) return {0, 0, 0, 0};
+            return { x - pad, y - pad, w + pad*2, h + pad*2 };
+        };
+        switch(idx){
+            case HUD_TITLE:      return text_rect(font_small, txt, 8, 8, 1, false);
+            case HUD_CONTROLS:   return text_rect(font_small, txt, 8, 770, 1, false);
+            case HUD_SWITCH:     return text_rect(font_small, txt, 900, 770, 1, false);
+            case HUD_AUTOSELECT: return text_rect(font, txt, 500, 770, 1, true);
+            case HUD_SCORE:      return text_rect(font, txt, SCREEN_W/2 - 35, 12, 13, true);
+            case HUD_GOAL:       return text_rect(font_large, txt, SCREEN_W/2 - 140, SCREEN_H/2 - 60, 21, true);
+            case HUD_DEBUG:      return { 0, 28, 560, 124 + (int)players.size() * 20 };
+        }
+        return {0, 0, 0, 0};
+    }
+
+    void draw_hud(int idx){
+        char buf[64];
+        const char* txt = hud_text(idx, buf, sizeof(buf));
+        if(!txt) return;
+        switch(idx){
+            case HUD_TITLE:      render_text_small(txt, 8, 8); break;
+            case HUD_CONTROLS:   render_text_small(txt, 8, 770); break;
+            case HUD_SWITCH:     render_text_small(txt, 900, 770); break;
+            case HUD_AUTOSELECT: render_text(txt, 500, 770); break;
+            case HUD_SCORE: {
+                SDL_Color white = {255, 255, 255, 255};
+                SDL_Color scoreBg = {0, 0, 0, 160};
+                render_text_with_bg(txt, SCREEN_W/2 - 35, 12, font, white, scoreBg, 12);
+                break;
+            }
+            case HUD_GOAL: {
+                SDL_Color yellow = {255, 235, 59, 255};
+                SDL_Color goalBg = {0, 0, 0, 200};
+                render_text_with_bg(txt, SCREEN_W/2 - 140, SCREEN_H/2 - 60, font_large, yellow, goalBg, 20);
+                break;
+            }
+            case HUD_DEBUG: render_debug_text(); break;
+        }
+    }
+
+    void render_debug_text(){
+        char dbg[128];
+        snprintf(dbg, sizeof(dbg), "Ball: (%.1f,%.1f) v(%.1f,%.1f)%s%s", ball.x, ball.y, ball.vx, ball.vy,
+                 ball.sleeping ? " [sleeping]" : "", worldIdle ? " [world idle]" : "");
+        render_text_small(dbg, 8, 80);
+        snprintf(dbg, sizeof(dbg), "Particles: %d/%d  spawned %d/%d  rejected %d  frames skipped %d",
+                 particles.count, ParticlePool::CAPACITY, particles.spawnedThisFrame,
+                 particles.budget, particles.rejectedThisFrame, framesSkipped);
+        render_text_small(dbg, 8, 56);
+        snprintf(dbg, sizeof(dbg), "Kits: %s vs %s  loaded %d  %zuKB/%zuKB  loads %d  evicted %d",
+                 KITS[homeKit].name, KITS[awayKit].name, kits.loaded_count(),
+                 kits.used / 1024, kits.budget / 1024, kits.loads, kits.evictions);
+        render_text_small(dbg, 8, 32);
+        snprintf(dbg, sizeof(dbg), "Quality: %s%s  frame %.1fms  work %.1fms  changes %d",
+                 quality.settings().name, quality.automatic ? " (auto)" : "",
+                 quality.interval * 1000.0f, quality.work * 1000.0f, quality.changes);
+        render_text_small(dbg, 8, 104);
+        snprintf(dbg, sizeof(dbg), "Players active: ");
+        render_text_small(dbg, 8, 128);
         for(size_t i=0;i<players.size();++i){
-            auto &p = players[i];
-            
-            // Draw kick range if player is active and can kick
-            if(p.active && p.canKickBall(ball)){
-                // màu vòng theo đội (alpha 80)
-                if(p.team == Team::Blue) SDL_SetRenderDrawColor(renderer, 120,170,255,80);
-                else                     SDL_SetRenderDrawColor(renderer, 255,170,60,80);
-                int kickX = p.r.x + p.r.w/2 - (int)p.kickRange;
-                int kickY = p.r.y + p.r.h/2 - (int)p.kickRange;
-                SDL_Rect kickRange = {kickX, kickY, (int)p.kickRange*2, (int)p.kickRange*2};
-                SDL_RenderFillRect(renderer, &kickRange);
+            char pinfo[64]; snprintf(pinfo, sizeof(pinfo), "P%d: x=%d y=%d AI=%d act=%d kick=%d", (int)i+1, players[i].r.x, players[i].r.y, players[i].isAI?1:0, players[i].active?1:0, players[i].canKickBall(ball)?1:0);
+            render_text_small(pinfo, 8, 148 + (int)i*20);
+        }
+    }
+
+    void draw_item(const DrawItem& it){
+        switch(it.kind){
+            case DRAW_PLAYER: {
+                auto &p = players[it.index];
+                // Draw kick range if player is active and can kick (cùng hình tròn mà canKickBall kiểm tra)
+                if(kick_range_shown(p)){
+                    // màu vòng theo đội (alpha 80)
+                    SDL_Color c = (p.team == Team::Blue) ? SDL_Color{120,170,255,80} : SDL_Color{255,170,60,80};
+                    fill_circle(p.r.x + p.r.w/2.0f, p.r.y + p.r.h/2.0f, p.kickRange, c);
+                }
+                // Draw player
+                const QualitySettings& q = quality.settings();
+                p.render(canvas, q.shadows, q.limbDetail);
+                break;
+            }
+            case DRAW_TRAILS: {
+                // trails (dưới bóng)
+                if(debug_trails_shown()){
+                    for(size_t i = 0; i < playerTrails.size(); ++i){
+                        SDL_Color c = (players[i].team == Team::Blue) ? SDL_Color{120,170,255,160} : SDL_Color{255,170,60,160};
+                        playerTrails[i].render(canvas, c, 4.0f, true);
+                    }
+                }
+                ballTrail.render(canvas, SDL_Color{255,255,255,140}, (float)ball.size * 0.6f, debug_trails_shown());
+                break;
+            }
+            case DRAW_BALL: {
+                SDL_Rect brect = ball.rect();
+                brect.x -= Ball::DRAW_OFFSET;
+                brect.y -= Ball::DRAW_OFFSET;
+                if(ball.tex){
+                    SDL_Point center = { brect.w/2, brect.h/2};
+                    canvas.copy_ex(ball.tex, NULL, &brect, ball.angle, &center, SDL_FLIP_NONE);
+                } else {
+                    canvas.fill_rect(brect, SDL_Color{255,255,255,255});
+                }
+                break;
             }
+            case DRAW_GOAL:
+                render_goal(canvas, PITCH.goals[it.index], it.index == 0); // cầu môn trái / phải
+                break;
+            case DRAW_PARTICLES:
+                particles.render(canvas);
+                break;
+            case DRAW_DEBUG_GEOMETRY:
+                queue_debug_geometry();
+                debugDraw.flush(canvas);
+                break;
+            case DRAW_HUD:
+                draw_hud(it.index);
+                break;
+        }
+    }
 
-            
-            // Draw player
-            p.render(renderer);
+    // Nền sân (phần tĩnh, vạch vôi đã vẽ sẵn trong texture)
+    void draw_background(Canvas& c){
+        c.clear();
+        if(bgTex){
+            SDL_Rect dst = {0, 0, SCREEN_W, SCREEN_H};
+            c.copy(bgTex, &dst);
+        }
+    }
 
-            // if(p.active){ // highlight border
-            //     SDL_SetRenderDrawColor(renderer, 255,255,0,200);
-            //     SDL_Rect border = {p.r.x-2, p.r.y-2, p.r.w+4, p.r.h+4};
-            //     SDL_RenderDrawRect(renderer, &border);
-            // }
+    void render(){
+        collect_draw_items();
+        if(cpuRaster){
+            render_cpu();
+            return;
+        }
+        if(softwareRender){
+            render_dirty();
+            return;
         }
 
-        // ball
-        SDL_Rect brect = ball.rect();
-        brect.x -= 12;
-        brect.y -= 12;
-        if(ball.tex){
-            SDL_Point center = { brect.w/2, brect.h/2};
-            SDL_RenderCopyEx(renderer, ball.tex, NULL, &brect, ball.angle, &center, SDL_FLIP_NONE);
-        } else {
-            SDL_SetRenderDrawColor(renderer, 255,255,255,255);
-            SDL_RenderFillRect(renderer, &brect);
+        draw_background(canvas);
+        for(int i = 0; i < drawItemCount; ++i) draw_item(drawItems[i]);
+        present();
+    }
+
+    // SDL_RenderPresent, ghi lại thời gian chờ vsync (không tính là việc của frame)
+    void present(){
+        Uint64 start = SDL_GetPerformanceCounter();
+        SDL_RenderPresent(renderer);
+        presentWait += (SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+    }
+
+    // Một frame replay vào canvas (chỉ ghi draw list, an toàn khi chạy song song)
+    void draw_replay_frame(Canvas& c, const ReplayFrame& f, std::vector<Player>& ps,
+                           const std::unordered_map<int, CpuImage>& scoreImages){
+        draw_background(c);
+        for(int i = 0; i < f.playerCount && i < (int)ps.size(); ++i){
+            Player& p = ps[i];
+            const ReplayPlayer& rp = f.players[i];
+            p.visX = rp.x; p.visY = rp.y;
+            p.moveX = rp.moveX; p.moveY = rp.moveY;
+            p.animTime = rp.animTime;
+            p.active = rp.active != 0;
+            p.render(c);
+        }
+
+        SDL_Rect brect = { (int)std::round(f.ballX) - Ball::DRAW_OFFSET, (int)std::round(f.ballY) - Ball::DRAW_OFFSET, ball.size, ball.size };
+        SDL_Point center = { brect.w/2, brect.h/2 };
+        c.copy_ex(ball.tex, NULL, &brect, f.ballAngle, &center, SDL_FLIP_NONE);
+        render_goal(c, PITCH.goals[0], true);
+        render_goal(c, PITCH.goals[1], false);
+
+        // tỉ số, cùng vị trí với HUD_SCORE
+        auto it = scoreImages.find(f.scoreLeft << 8 | f.scoreRight);
+        if(it != scoreImages.end()){
+            const CpuImage& img = it->second;
+            const int x = SCREEN_W/2 - 35, y = 12, pad = 12;
+            c.fill_rect({ x - pad, y - pad, img.w + pad*2, img.h + pad*2 }, SDL_Color{0, 0, 0, 160});
+            c.list->sprite(&img, nullptr, (float)x, (float)y, (float)img.w, (float)img.h, 0.0, 0.0f, 0.0f, SDL_FLIP_NONE, Canvas::WHITE);
         }
+    }
 
-        float scale = 0.8f;
-        int goalWidth  = SCREEN_W * 0.108 * scale;   // giảm cả width
-        int goalHeight = SCREEN_H * 0.15 * scale;    // giảm cả height
+    // Dựng replay thành video Y4M: mỗi frame nội suy từ 2 keyframe quanh nó nên
+    // các frame độc lập, render song song theo lô (1 frame / thread), ghi theo thứ tự
+    bool export_replay(const Replay& rp, const char* outPath, int outW, int outH, int fps){
+        if(rp.frames.empty()){ LOG_ERROR("Export: replay is empty"); return false; }
+        if(outW <= 0 || outH <= 0 || (outW | outH) & 1 || fps <= 0){ LOG_ERROR("Export: size must be even and fps > 0"); return false; }
+        Y4MWriter out;
+        if(!out.open(outPath, outW, outH, fps)){ LOG_ERROR("Export: cannot write %s", outPath); return false; }
+
+        // TTF không thread-safe: dựng sẵn chữ tỉ số trên main thread
+        std::unordered_map<int, CpuImage> scoreImages;
+        for(const ReplayFrame& f : rp.frames){
+            int key = f.scoreLeft << 8 | f.scoreRight;
+            if(!font || scoreImages.count(key)) continue;
+            char txt[32];
+            snprintf(txt, sizeof(txt), "%d  -  %d", f.scoreLeft, f.scoreRight);
+            TTF_SetFontStyle(font, TTF_STYLE_BOLD);
+            SDL_Surface* surf = TTF_RenderText_Blended(font, txt, SDL_Color{255, 255, 255, 255});
+            TTF_SetFontStyle(font, TTF_STYLE_NORMAL);
+            if(!surf) continue;
+            cpu_image_from_surface(scoreImages[key], surf);
+            SDL_FreeSurface(surf);
+        }
 
-        int goalCenterY = SCREEN_H / 2;  
-        int goalY = goalCenterY - goalHeight / 2;  // cập nhật lại Y
-        render_goal(+39, goalY, goalWidth, goalHeight, true);   // cầu môn trái
-        render_goal(SCREEN_W - goalWidth +16, goalY, goalWidth, goalHeight, false); // cầu môn phải
+        struct Slot {
+            CpuDrawList list;
+            std::vector<uint32_t> rgb;
+            std::vector<uint8_t> yuv;
+            std::vector<Player> players;
+        };
+        const int threads = workers ? workers->size() : 1;
+        std::vector<Slot> slots(threads);
+        for(Slot& s : slots){
+            s.rgb.resize((size_t)outW * outH);
+            s.yuv.resize((size_t)outW * outH * 3 / 2);
+            s.players = players;
+        }
+        // giữ tỉ lệ khung hình, khung hình ở giữa, hai dải thừa để đen
+        const float scale = std::min(outW / (float)SCREEN_W, outH / (float)SCREEN_H);
+        const int viewW = std::min(outW, (int)lroundf(SCREEN_W * scale));
+        const int viewH = std::min(outH, (int)lroundf(SCREEN_H * scale));
+        const int total = (int)(rp.duration() * fps) + 1;
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        bool ok = true;
+        for(int first = 0; first < total && ok; first += threads){
+            const int n = std::min(threads, total - first);
+            auto renderFrame = [&](int k){
+                Slot& s = slots[k];
+                s.list.reset(viewW, viewH, scale, (outW - viewW) / 2, (outH - viewH) / 2);
+                Canvas c;
+                c.list = &s.list;
+                c.images = &cpu.images;
+                draw_replay_frame(c, rp.sample((first + k) / (float)fps), s.players, scoreImages);
+                s.list.raster(s.rgb.data(), outW, SDL_Rect{0, 0, outW, outH}, cpu.avx2);
+                rgb_to_yuv420(s.rgb.data(), outW, outW, outH, s.yuv.data());
+            };
+            if(workers) workers->parallel_for(n, renderFrame);
+            else renderFrame(0);
+            for(int k = 0; k < n && ok; ++k) ok = out.write_frame(slots[k].yuv.data());
+            if((first / threads) % 30 == 0){
+                printf("Export: %d/%d frames\r", first + n, total);
+                fflush(stdout);
+            }
+        }
+        ok = out.close() && ok;
+        double secs = (SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+        printf("\n");
+        if(ok) LOG_INFO("Export done: %d frames %dx%d@%d in %.1fs (%d threads)", total, outW, outH, fps, secs, threads);
+        else LOG_ERROR("Export FAILED after %.1fs", secs);
+        return ok;
+    }
 
-        // HUD
-        render_text_small("Tiny Football", 8, 8);
-        render_text_small("Controls: WASD+Q (Blue Team), Arrows+Enter (Orange Team)", 8, 770);
-        render_text_small("Switch Player: Q+Tab (Blue), P+RShift (Orange)", 900, 770);
+    // CPU rasterizer: sân, cầu thủ, bóng, hiệu ứng ghi vào draw list rồi
+    // rasterize song song theo tile; HUD chữ vẫn vẽ bằng SDL phía trên
+    void render_cpu(){
+        cpu.begin(SCREEN_W, SCREEN_H);
+        draw_background(canvas);
+        for(int i = 0; i < drawItemCount; ++i){
+            if(drawItems[i].kind != DRAW_HUD) draw_item(drawItems[i]);
+        }
+        cpu.rasterize();
+        if(!cpu.present(renderer)) LOG_ERROR("CPU raster: could not create frame texture: %s", SDL_GetError());
+        for(int i = 0; i < drawItemCount; ++i){
+            if(drawItems[i].kind == DRAW_HUD) draw_item(drawItems[i]);
+        }
+        present();
+        if(softwareRender) SDL_UpdateWindowSurface(window);
+    }
 
-        if(autoSelectEnabled){
-            render_text("AUTO-SELECT: ON", 500, 770);
+    // Software renderer: chỉ vẽ lại các vùng có item thay đổi (vị trí cũ + mới),
+    // khôi phục nền từ staticTex rồi vẽ lại các item giao với vùng đó (có clip).
+    void render_dirty(){
+        dirty.clear();
+        if(fullRepaint || !staticTex || prevDrawItemCount != drawItemCount){
+            dirty.add_full();
         } else {
-            render_text("AUTO-SELECT: OFF", 500, 770);
-        }
-
-        char scoreText[64]; 
-        snprintf(scoreText, sizeof(scoreText), "%d  -  %d", score.left, score.right);
-        SDL_Color white = {255, 255, 255, 255};
-        SDL_Color scoreBg = {0, 0, 0, 160};
-        render_text_with_bg(scoreText, SCREEN_W/2 - 35, 12, font, white, scoreBg, 12);
-
-        if(goalMessageTimer > 0.0f && font_large){
-            SDL_Color yellow = {255, 235, 59, 255};
-            SDL_Color goalBg = {0, 0, 0, 200};
-            render_text_with_bg("GOAL!!!", SCREEN_W/2 - 140, SCREEN_H/2 - 60, font_large, yellow, goalBg, 20);
-        }
-
-        if(showDebug){
-            char dbg[128];
-            snprintf(dbg, sizeof(dbg), "Ball: (%.1f,%.1f) v(%.1f,%.1f)", ball.x, ball.y, ball.vx, ball.vy);
-            render_text_small(dbg, 8, 80);
-            snprintf(dbg, sizeof(dbg), "Players active: ");
-            render_text_small(dbg, 8, 104);
-            for(size_t i=0;i<players.size();++i){
-                char pinfo[64]; snprintf(pinfo, sizeof(pinfo), "P%d: x=%d y=%d AI=%d act=%d kick=%d", (int)i+1, players[i].r.x, players[i].r.y, players[i].isAI?1:0, players[i].active?1:0, players[i].canKickBall(ball)?1:0);
-                render_text_small(pinfo, 8, 124 + (int)i*20);
+            for(int i = 0; i < drawItemCount; ++i){
+                const DrawItem& cur = drawItems[i];
+                const DrawItem& old = prevDrawItems[i];
+                if(cur.hash != old.hash || !SDL_RectEquals(&cur.bounds, &old.bounds)){
+                    dirty.add(old.bounds);
+                    dirty.add(cur.bounds);
+                }
+            }
+        }
+        dirty.finalize(SCREEN_W, SCREEN_H);
+        fullRepaint = false;
+
+        for(int r = 0; r < dirty.count; ++r){
+            const SDL_Rect& area = dirty.rects[r];
+            SDL_RenderSetClipRect(renderer, &area);
+            if(staticTex) SDL_RenderCopy(renderer, staticTex, &area, &area);
+            else draw_background(canvas);
+            for(int i = 0; i < drawItemCount; ++i){
+                if(SDL_HasIntersection(&drawItems[i].bounds, &area)) draw_item(drawItems[i]);
             }
         }
+        SDL_RenderSetClipRect(renderer, nullptr);
+        if(dirty.count > 0) SDL_UpdateWindowSurfaceRects(window, dirty.rects, dirty.count);
 
-        SDL_RenderPresent(renderer);
+        for(int i = 0; i < drawItemCount; ++i) prevDrawItems[i] = drawItems[i];
+        prevDrawItemCount = drawItemCount;
+    }
+
+    bool window_hidden() const {
+        return window && (SDL_GetWindowFlags(window) & (SDL_WINDOW_MINIMIZED | SDL_WINDOW_HIDDEN));
+    }
+
+    // Mọi thứ render() đọc mà có thể đổi giữa các frame
+    uint64_t visible_state_hash() const {
+        Fnv1a h;
+        h.add(ball.x); h.add(ball.y); h.add(ball.angle);
+        for(const auto &p : players){
+            h.add(p.visX); h.add(p.visY); h.add(p.moveX); h.add(p.moveY); h.add(p.animTime);
+            h.add(p.r); h.add(p.active); h.add(p.isAI);
+        }
+        h.add(score.left); h.add(score.right);
+        h.add(goalMessageTimer > 0.0f);
+        h.add(autoSelectEnabled); h.add(showDebug); h.add(debugDraw.enabled); h.add(quality.level);
+        h.add(particles.count);
+        h.add(ballTrail.head); h.add(ballTrail.count);
+        return h.value();
+    }
+
+    // Vẽ nếu có gì thay đổi, trả về true nếu đã present
+    bool render_if_changed(){
+        if(window_hidden()) return false;
+        uint64_t hash = visible_state_hash();
+        if(!forceRedraw && particles.count == 0 && hash == lastFrameHash){
+            ++framesSkipped;
+            metrics.framesSkipped.add();
+            presentStreak = false;
+            return false;
+        }
+        lastFrameHash = hash;
+        fullRepaint |= forceRedraw;
+        forceRedraw = false;
+        Uint64 start = SDL_GetPerformanceCounter();
+        presentWait = 0.0;
+        render();
+        double frameSeconds = (SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+        metrics.frame.observe(frameSeconds);
+        renderWork = frameSeconds - presentWait;
+        metrics.frames.add();
+        if(pendingInputTicks){
+            metrics.inputLatency.observe((SDL_GetTicks() - pendingInputTicks) / 1000.0);
+            pendingInputTicks = 0;
+        }
+        return true;
     }
 
     void cleanup(){
+        assetWatch.stop();
+        metricsServer.stop();
+        metrics.matchesRunning.set(0);
+        if(recordPath){
+            replay.seed = seed;
+            if(replay.save(recordPath)) LOG_INFO("Replay saved: %s (%.1fs)", recordPath, replay.duration());
+            else LOG_ERROR("Could not save replay to %s", recordPath);
+        }
         if(font) TTF_CloseFont(font);
         if(font_small) TTF_CloseFont(font_small);
         if(font_large) TTF_CloseFont(font_large);
         if(bgTex) SDL_DestroyTexture(bgTex);
+        if(staticTex) SDL_DestroyTexture(staticTex);
+        kits.clear();
+        cpu.destroy();
+        workers.reset();
         if(elementsTex) SDL_DestroyTexture(elementsTex);
         if(renderer) SDL_DestroyRenderer(renderer);
         if(window) SDL_DestroyWindow(window);
@@ -1048,10 +2352,1061 @@ struct Game {
     }
 };
 
+// =====================================
+// AI behavior tree: lá (khai báo ở AiLeaves)
+// =====================================
+BtStatus AiLeaves::leaf(const BtInstr& in){
+    const Ball& ball = g.ball;
+    const float bx = ball.x + ball.size/2.0f, by = ball.y + ball.size/2.0f;
+    const float px = p.r.x + p.r.w/2.0f, py = p.r.y + p.r.h/2.0f;
+    auto ok = [](bool b){ return b ? BT_SUCCESS : BT_FAILURE; };
+    switch(in.leaf){
+    case AI_BALL_NEAR_OWN_GOAL:
+        return ok(PITCH.goals[p.team == Team::Blue ? 0 : 1].distanceSq(bx, by) < in.arg[0]*in.arg[0]);
+    case AI_BALL_IN_OWN_HALF: return ok((bx < PITCH.centerSpot.x) == (p.team == Team::Blue));
+    case AI_BALL_WITHIN: return ok((bx-px)*(bx-px) + (by-py)*(by-py) < in.arg[0]*in.arg[0]);
+    case AI_CAN_KICK: return ok(p.canKickBall(ball));
+    case AI_TRACK_BALL_Y: {
+        const PitchRect& box = PITCH.goalArea[p.team == Team::Blue ? 0 : 1];
+        p.aiTargetX = px;
+        p.aiTargetY = clampf(by, box.top(), box.bottom());
+        return BT_SUCCESS;
+    }
+    case AI_CHASE_BALL: p.aiTargetX = bx; p.aiTargetY = by; return BT_SUCCESS;
+    case AI_URGENCY: p.aiUrgency = in.arg[0]; return BT_SUCCESS;
+    case AI_KICK:
+        if(!p.canKickBall(ball)) return BT_FAILURE;
+        p.aiKick = true;
+        return BT_SUCCESS;
+    case AI_PASS_OPEN: {
+        const PlayOptions& o = g.play_options(p.team);
+        return ok(o.carrier >= 0 && &g.players[o.carrier] == &p && o.best_pass_score() >= in.arg[0]);
+    }
+    case AI_SHOT_OPEN: {
+        const PlayOptions& o = g.play_options(p.team);
+        return ok(o.carrier >= 0 && &g.players[o.carrier] == &p && o.best_shot_score() >= in.arg[0]);
+    }
+    case AI_AIM_PASS: {
+        const PlayOptions& o = g.play_options(p.team);
+        if(o.bestPass < 0) return BT_FAILURE;
+        const Player& q = g.players[o.passTo[o.bestPass]];
+        return ok(aim_at(q.r.x + q.r.w/2.0f, q.r.y + q.r.h/2.0f));
+    }
+    case AI_AIM_SHOT: {
+        const PlayOptions& o = g.play_options(p.team);
+        if(o.bestShot < 0) return BT_FAILURE;
+        return ok(aim_at(o.shotX[o.bestShot], o.shotY[o.bestShot]));
+    }
+    case AI_AIMED: {
+        // Ball::kick đẩy bóng theo hướng tâm cầu thủ -> tâm bóng
+        float kx = bx - px, ky = by - py;
+        float kl = std::sqrt(kx*kx + ky*ky);
+        if(kl < 1e-3f) return BT_FAILURE;
+        return ok((kx*p.aiAimX + ky*p.aiAimY) / kl >= std::cos(in.arg[0] * (float)M_PI / 180.0f));
+    }
+    }
+    return BT_FAILURE;
+}
+
+// Đứng sau bóng, thẳng hàng với (tx, ty): cú sút từ đó đi về phía đích
+bool AiLeaves::aim_at(float tx, float ty){
+    const float bx = g.ball.x + g.ball.size/2.0f, by = g.ball.y + g.ball.size/2.0f;
+    float dx = tx - bx, dy = ty - by;
+    float l = std::sqrt(dx*dx + dy*dy);
+    if(l < 1e-3f) return false;
+    p.aiAimX = dx / l; p.aiAimY = dy / l;
+    const float behind = g.ball.size/2.0f + p.r.h/2.0f + 4.0f;
+    p.aiTargetX = bx - p.aiAimX * behind;
+    p.aiTargetY = by - p.aiAimY * behind;
+    return true;
+}
+
+// =====================================
+// Scenarios (--scenario): kịch bản cố định, chạy headless với tick cố định.
+// Vừa là regression test vừa là benchmark cho các ca vật lý khó.
+// =====================================
+constexpr float SCENARIO_DT = 1.0f / 60.0f;
+constexpr int SCENARIO_MAX_TICKS = 60 * 60;
+
+float ball_cx(const Game& g){ return g.ball.x + g.ball.size/2.0f; }
+float ball_cy(const Game& g){ return g.ball.y + g.ball.size/2.0f; }
+
+// Trận mới, tắt tự chọn cầu thủ, không ai được điều khiển
+void prepare_scenario(Game& g){
+    g.seed_match(1);
+    g.setup_match();
+    g.score = {};
+    g.autoSelectEnabled = false;
+    for(auto &p : g.players) p.active = false;
+}
+
+void place_ball(Game& g, float cx, float cy, float vx = 0.0f, float vy = 0.0f){
+    g.ball.x = cx - g.ball.size/2.0f;
+    g.ball.y = cy - g.ball.size/2.0f;
+    g.ball.vx = vx; g.ball.vy = vy;
+    g.ball.angle = 0.0f; g.ball.spinSpeed = 0.0f;
+    g.ball.sleeping = false;
+}
+
+void place_player(Player& p, float cx, float cy){
+    p.r.x = (int)lroundf(cx - p.r.w/2.0f);
+    p.r.y = (int)lroundf(cy - p.r.h/2.0f);
+    p.visX = (float)p.r.x; p.visY = (float)p.r.y;
+}
+
+bool ball_on_pitch(const Game& g){
+    float cx = ball_cx(g), cy = ball_cy(g);
+    return std::isfinite(cx) && std::isfinite(cy) && PITCH.bounds.contains(cx, cy);
+}
+
+bool event_this_tick(const Game& g, SimEventType type){
+    for(const SimEvent& e : g.events) if(e.type == type) return true;
+    return false;
+}
+
+// Giao bóng: bóng lăn về phần sân trái rồi dừng, không thành bàn
+ScenarioTask scenario_kickoff(Game& g, ScenarioContext& sc){
+    prepare_scenario(g);
+    g.ball.reset(true, g.rng);
+    co_await sc.ticks(1);
+    sc.check(g.ball.vx < 0.0f, "kickoff ball heads left");
+    bool rested = co_await sc.until([&]{ return g.ball.sleeping; }, 600);
+    sc.check(rested, "ball comes to rest within 10 s");
+    sc.check(g.score.left == 0 && g.score.right == 0, "no goal from a kickoff");
+    sc.check(ball_on_pitch(g), "ball stays on the pitch");
+}
+
+// Penalty vào góc dưới khung thành phải, thủ môn đứng giữa không cản được
+ScenarioTask scenario_penalty(Game& g, ScenarioContext& sc){
+    prepare_scenario(g);
+    const PitchPoint spot = PITCH.penaltySpot[1];
+    const GoalMouth& goal = PITCH.goals[1];
+    place_ball(g, spot.x, spot.y);
+    float ax = goal.lineX - spot.x, ay = goal.bottom - 12.0f - spot.y;
+    float len = std::sqrt(ax*ax + ay*ay);
+    Player& shooter = g.players[2];
+    place_player(shooter, spot.x - ax / len * 25.0f, spot.y - ay / len * 25.0f);
+    shooter.active = true;
+    sc.check(shooter.canKickBall(g.ball), "shooter starts in kick range");
+
+    sc.hold(shooter.kick);
+    co_await sc.ticks(1);
+    sc.release_all();
+    sc.check(event_this_tick(g, SimEventType::Kick), "kick registered");
+    bool scored = co_await sc.until([&]{ return g.score.left > 0; }, 120);
+    sc.check(scored, "penalty goes in");
+    sc.check(g.score.right == 0, "only the shooting side scores");
+    sc.check(fabsf(ball_cx(g) - PITCH.centerSpot.x) < 20.0f, "ball restarts from the centre");
+}
+
+// Đột phá: chạy theo bóng, mỗi lần tới sau bóng lại chạm nhẹ về phía góc dưới khung thành
+// (tránh thủ môn đứng giữa), tới khi thành bàn. Input được tính lại mỗi tick như người chơi thật.
+ScenarioTask scenario_breakaway(Game& g, ScenarioContext& sc){
+    prepare_scenario(g);
+    const GoalMouth& goal = PITCH.goals[1];
+    const float tx = goal.lineX + 10.0f, ty = goal.bottom - 20.0f;
+    Player& striker = g.players[2];
+    place_player(striker, 540.0f, 450.0f);
+    striker.active = true;
+    place_ball(g, 580.0f, 450.0f);
+
+    int touches = 0;
+    bool reachedBox = false, stayedOn = true;
+    while(g.score.left == 0 && sc.tick < 900){
+        // điểm đứng sau bóng, thẳng hàng với đích sút
+        float dx = tx - ball_cx(g), dy = ty - ball_cy(g);
+        float len = std::max(1.0f, std::sqrt(dx*dx + dy*dy));
+        float ax = ball_cx(g) - dx / len * 26.0f, ay = ball_cy(g) - dy / len * 26.0f;
+        float px = striker.r.x + striker.r.w/2.0f, py = striker.r.y + striker.r.h/2.0f;
+        sc.release_all();
+        if(ax - px > 4.0f) sc.hold(striker.right);
+        if(px - ax > 4.0f) sc.hold(striker.left);
+        if(ay - py > 4.0f) sc.hold(striker.down);
+        if(py - ay > 4.0f) sc.hold(striker.up);
+        if(fabsf(ax - px) <= 6.0f && fabsf(ay - py) <= 6.0f && striker.canKickBall(g.ball)){
+            sc.hold(striker.kick);
+            ++touches;
+        }
+        reachedBox |= PITCH.penaltyArea[1].contains(ball_cx(g), ball_cy(g));
+        co_await sc.ticks(1);
+        stayedOn &= ball_on_pitch(g);
+    }
+    sc.check(stayedOn, "ball stays on the pitch");
+    sc.check(reachedBox, "ball carried into the penalty area");
+    sc.check(g.score.left == 1 && g.score.right == 0, "breakaway ends in a goal");
+    sc.check(touches >= 2, "goal came from a run, not a single shot");
+}
+
+// Bóng bị ép vào tường / lao vào góc: phải được đẩy ra, bật lại và nằm trong sân
+ScenarioTask scenario_wall_stuck(Game& g, ScenarioContext& sc){
+    prepare_scenario(g);
+    // tâm bóng nằm sẵn trong tường trên, không có vận tốc
+    place_ball(g, 640.0f, PITCH.bounds.top() + 2.0f);
+    co_await sc.ticks(1);
+    sc.check(ball_cy(g) - g.ball.size/2.0f >= PITCH.bounds.top() - 0.01f, "ball pushed out of the top wall");
+    bool rested = co_await sc.until([&]{ return g.ball.sleeping; }, 60);
+    sc.check(rested, "ball against the wall comes to rest (no jitter)");
+
+    // lao thẳng vào góc phải trên
+    place_ball(g, PITCH.bounds.right() - 40.0f, PITCH.bounds.top() + 40.0f, 700.0f, -700.0f);
+    bool bounced = co_await sc.until([&]{ return g.ball.vx < 0.0f && g.ball.vy > 0.0f; }, 30);
+    sc.check(bounced, "ball bounces off both corner walls");
+    bool escaped = co_await sc.until([&]{ return !ball_on_pitch(g); }, 240);
+    sc.check(!escaped, "ball stays inside the walls");
+
+    // lướt dọc tường dưới
+    place_ball(g, 300.0f, PITCH.bounds.bottom() - g.ball.size/2.0f - 0.5f, 800.0f, 5.0f);
+    escaped = co_await sc.until([&]{ return !ball_on_pitch(g); }, 240);
+    sc.check(!escaped, "grazing ball stays inside the walls");
+    sc.check(g.ball.x > 300.0f, "grazing ball keeps moving along the wall");
+}
+
+// Bầy AI đuổi theo bóng (scenario crowd, --bench-crowd): n cầu thủ AI rải ngẫu nhiên trên sân
+constexpr const char* CHASE_AI_TREE = "sequence\n  chase_ball\n  urgency 1\n";
+
+void add_chasers(Game& g, int n, uint64_t seed){
+    std::string err;
+    if(!g.aiTree.compile(CHASE_AI_TREE, AI_LEAVES, AI_LEAF_COUNT, err, "chase")) LOG_ERROR("AI tree: %s", err);
+    Pcg32 rng(seed, 7);
+    for(int i = 0; i < n; ++i){
+        Player p(0, 0, 21, 31);
+        p.isAI = true;
+        p.active = false;
+        p.team = i % 2 ? Team::Red : Team::Blue;
+        place_player(p, rng.range(PITCH.bounds.left() + 20.0f, PITCH.bounds.right() - 20.0f),
+                        rng.range(PITCH.bounds.top() + 20.0f, PITCH.bounds.bottom() - 20.0f));
+        g.players.push_back(p);
+    }
+    g.playerTrails.resize(g.players.size());
+}
+
+// Cặp cầu thủ lấn vào nhau quá 1/4 đường kính né (O(n²), chỉ để kiểm tra)
+int overlapping_pairs(const Game& g){
+    const float minDist = 2.0f * Game::AVOID_RADIUS * 0.75f;
+    int pairs = 0;
+    for(size_t i = 0; i < g.players.size(); ++i){
+        const SDL_Rect& a = g.players[i].r;
+        for(size_t j = i + 1; j < g.players.size(); ++j){
+            const SDL_Rect& b = g.players[j].r;
+            float dx = (a.x + a.w/2.0f) - (b.x + b.w/2.0f), dy = (a.y + a.h/2.0f) - (b.y + b.h/2.0f);
+            pairs += dx*dx + dy*dy < minDist * minDist;
+        }
+    }
+    return pairs;
+}
+
+// 24 AI cùng lao vào quả bóng giữa sân: phải dồn quanh bóng mà không chồng lên nhau
+ScenarioTask scenario_crowd(Game& g, ScenarioContext& sc){
+    prepare_scenario(g);
+    add_chasers(g, 24, 3);
+    place_ball(g, PITCH.centerSpot.x, PITCH.centerSpot.y);
+    co_await sc.ticks(240);
+    sc.check(overlapping_pairs(g) == 0, "no two players overlap");
+    int near = 0;
+    for(const Player& p : g.players){
+        float dx = p.r.x + p.r.w/2.0f - ball_cx(g), dy = p.r.y + p.r.h/2.0f - ball_cy(g);
+        near += p.isAI && dx*dx + dy*dy < 160.0f * 160.0f;
+    }
+    sc.check(near >= 20, "crowd gathers around the ball");
+    sc.check(ball_on_pitch(g), "ball stays on the pitch");
+}
+
+// Giống data/ai/attacker.bt (scenario ai_tree_sync kiểm tra); dùng cho ai_shot và --bench-ai-schedule
+constexpr const char* ATTACKER_AI_TREE_FILE = "../data/ai/attacker.bt";
+constexpr const char* ATTACKER_AI_TREE = R"(
+selector
+  sequence
+    shot_open 0.5
+    aim_shot
+    urgency 1
+    succeed
+      sequence
+        aimed 20
+        kick
+  sequence
+    pass_open 0.6
+    aim_pass
+    urgency 0.9
+    succeed
+      sequence
+        aimed 20
+        kick
+  sequence
+    chase_ball
+    urgency 1
+)";
+
+// Tiền đạo AI trước khung thành trống, lệch góc: phải vòng ra sau bóng, ngắm cửa trống rồi sút vào
+ScenarioTask scenario_ai_shot(Game& g, ScenarioContext& sc){
+    prepare_scenario(g);
+    std::string err;
+    sc.check(g.aiTree.compile(ATTACKER_AI_TREE, AI_LEAVES, AI_LEAF_COUNT, err, "attacker"), "attacker tree compiles");
+    Player& striker = g.players[2];
+    striker.isAI = true;
+    const GoalMouth& m = PITCH.goals[1];
+    place_ball(g, m.lineX - 180.0f, m.centerY() + 110.0f);
+    place_player(striker, m.lineX - 140.0f, m.centerY() + 170.0f); // đứng chếch phía trước bóng
+    place_player(g.players[7], m.lineX - 60.0f, PITCH.touchlines.y + 40.0f); // thủ môn bị kéo lên biên
+    const PlayOptions& o = g.play_options(Team::Blue);
+    sc.check(o.carrier == 2 && o.best_shot_score() >= 0.5f, "open shot seen from the ball");
+    bool scored = co_await sc.until([&]{ return g.score.left > 0; }, 300);
+    sc.check(scored, "AI striker lines up and scores");
+    sc.check(g.score.right == 0, "no own goal");
+}
+
+// Lịch replan của AI: ở mức quality cao nhất (mặc định) mỗi tick vẫn chỉ ~1/4 số AI tính lại, quality
+// thấp chỉ giãn chu kỳ ra; cú sút làm tất cả tính lại ở tick sau, ngân sách thời gian đẩy phần dư sang
+// tick kế (việc khẩn vẫn đi trước)
+ScenarioTask scenario_ai_schedule(Game& g, ScenarioContext& sc){
+    prepare_scenario(g);
+    const int period = g.ai_replan_period();
+    sc.check(period == g.aiReplanTicks && period > 1, "full quality keeps the staggered period");
+    g.quality.set_fixed(0);
+    sc.check(g.ai_replan_period() > period, "low quality stretches the period");
+    g.quality.set_fixed(QUALITY_LEVEL_COUNT - 1);
+    Player& striker = g.players[2];
+    for(auto &p : g.players) p.isAI = &p != &striker;
+    const int agents = (int)g.players.size() - 1;
+    striker.active = true;
+    place_ball(g, PITCH.centerSpot.x, PITCH.centerSpot.y);
+    place_player(striker, PITCH.centerSpot.x - 24.0f, PITCH.centerSpot.y);
+
+    AiScheduler& s = g.aiSchedule;
+    uint64_t before = s.plans;
+    int most = 0;
+    for(int t = 0; t < 2 * period; ++t){
+        uint64_t tick = s.plans;
+        co_await sc.ticks(1);
+        most = std::max(most, (int)(s.plans - tick));
+    }
+    sc.check(s.plans - before == (uint64_t)(2 * agents), "each AI plans once every period");
+    sc.check(most <= (agents + period - 1) / period, "plans are staggered across ticks");
+
+    // Quality giãn chu kỳ: lệch pha trải lại ngay trên chu kỳ mới
+    g.quality.set_fixed(0);
+    const int stretched = g.ai_replan_period();
+    most = 0;
+    for(int t = 0; t < stretched; ++t){
+        uint64_t tick = s.plans;
+        co_await sc.ticks(1);
+        most = std::max(most, (int)(s.plans - tick));
+    }
+    sc.check(most <= (agents + stretched - 1) / stretched, "a new period re-spreads the due ticks");
+    g.quality.set_fixed(QUALITY_LEVEL_COUNT - 1);
+
+    // Người và AI xen kẽ: lệch pha theo thứ tự giữa các AI, không theo chỉ số cầu thủ
+    int every = 0;
+    for(size_t i = 0; i < g.players.size(); ++i){
+        g.players[i].isAI = i % 2 == 1;
+        every += g.players[i].isAI;
+    }
+    most = 0;
+    for(int t = 0; t < period; ++t){
+        uint64_t tick = s.plans;
+        co_await sc.ticks(1);
+        most = std::max(most, (int)(s.plans - tick));
+    }
+    sc.check(most <= (every + period - 1) / period, "agents are staggered by rank, not slot");
+    for(auto &p : g.players) p.isAI = &p != &striker;
+
+    sc.hold(striker.kick);
+    co_await sc.ticks(1);
+    sc.release_all();
+    before = s.urgentPlans;
+    co_await sc.ticks(1);
+    sc.check(s.urgentPlans - before == (uint64_t)agents, "a kick makes every AI re-plan on the next tick");
+
+    // Ngân sách gần như bằng 0: mỗi tick chỉ kịp AiScheduler::CLOCK_EVERY lượt
+    s.budgetUs = 0.001f;
+    s.request_all();
+    before = s.urgentPlans;
+    const uint64_t deferred = s.deferred;
+    co_await sc.ticks(1);
+    sc.check(s.urgentPlans - before == (uint64_t)AiScheduler::CLOCK_EVERY, "budget stops planning early");
+    sc.check(s.deferred - deferred == (uint64_t)(agents - AiScheduler::CLOCK_EVERY), "the rest is deferred");
+    co_await sc.ticks(1);
+    sc.check(s.urgentPlans - before == (uint64_t)agents, "deferred urgent plans run first on the next tick");
+}
+
+// Cây dựng sẵn và file trong data/ai/ phải ra cùng bytecode, không thì headless và game chạy AI khác nhau
+ScenarioTask scenario_ai_tree_sync(Game&, ScenarioContext& sc){
+    const struct { const char* file; const char* src; } trees[] = {
+        { DEFAULT_AI_TREE_FILE,  DEFAULT_AI_TREE },
+        { ATTACKER_AI_TREE_FILE, ATTACKER_AI_TREE },
+    };
+    for(const auto& t : trees){
+        if(!std::filesystem::exists(t.file)){
+            LOG_INFO("Scenario ai_tree_sync: %s not found (run from build/), nothing to compare", t.file);
+            continue;
+        }
+        BtProgram file, embedded;
+        std::string err;
+        bool loaded = file.load(t.file, AI_LEAVES, AI_LEAF_COUNT, err) &&
+                      embedded.compile(t.src, AI_LEAVES, AI_LEAF_COUNT, err, "embedded");
+        if(!loaded) LOG_ERROR("AI tree: %s", err);
+        sc.check(loaded, "tree compiles");
+        sc.check(loaded && file.same_code(embedded), "embedded tree matches the file in data/ai/");
+    }
+    co_return;
+}
+
+// Cây mặc định: chạy hết tốc (1.0) khi bóng gần khung thành đội mình phòng thủ, còn lại 0.8,
+// kể cả khi bóng sát khung thành đối phương
+ScenarioTask scenario_ai_urgency(Game& g, ScenarioContext& sc){
+    prepare_scenario(g);
+    std::string err;
+    sc.check(g.aiTree.compile(DEFAULT_AI_TREE, AI_LEAVES, AI_LEAF_COUNT, err, "embedded"), "default tree compiles");
+    for(size_t i = 0; i < g.players.size(); ++i){
+        const Player& p = g.players[i];
+        const int own = p.team == Team::Blue ? 0 : 1;
+        const GoalMouth& home = PITCH.goals[own];
+        const GoalMouth& away = PITCH.goals[1 - own];
+        place_ball(g, away.lineX - away.inward * 60.0f, away.centerY());
+        g.plan_ai(i);
+        sc.check(p.aiUrgency == 0.8f, "ball at the opponents' goal: urgency 0.8");
+        place_ball(g, home.lineX + home.inward * 60.0f, home.centerY());
+        g.plan_ai(i);
+        sc.check(p.aiUrgency == 1.0f, "ball at the own goal: urgency 1.0");
+    }
+    co_return;
+}
+
+// Đổi áo liên tục quá ngân sách KitCache: bộ vừa thay ra bị evict nhưng bộ hai đội đang mặc thì không,
+// mỗi lần đổi chỉ nạp đúng bộ mới. Headless không có renderer nên texture là con trỏ giả, cỡ ~ một bộ thật
+ScenarioTask scenario_kit_budget(Game& g, ScenarioContext& sc){
+    prepare_scenario(g);
+    static char fake[KIT_COUNT];
+    bool onPitchEvicted = false;
+    g.kits.clear();
+    g.kits.load = [](const char* path) -> SDL_Texture* {
+        for(int k = 0; k < KIT_COUNT; ++k){
+            char dir[32];
+            snprintf(dir, sizeof(dir), "/%s/", KITS[k].folder);
+            if(strstr(path, dir)) return reinterpret_cast<SDL_Texture*>(&fake[k]);
+        }
+        return nullptr;
+    };
+    g.kits.release = [&](SDL_Texture* t){
+        const int k = (int)(reinterpret_cast<char*>(t) - fake);
+        if(k == g.homeKit || k == g.awayKit) onPitchEvicted = true;
+    };
+    g.kits.measure = [](SDL_Texture*){ return (size_t)1600; };
+    g.kits.budget = 2 * 3 * 1600; // vừa đủ hai bộ trên sân: mỗi lần đổi phải evict
+    g.set_team_kit(Team::Blue, 0);
+    g.set_team_kit(Team::Red, 1);
+    g.bind_kits();
+    bool oneLoadPerSwap = true;
+    for(int i = 0; i < 4 * KIT_COUNT; ++i){
+        g.cycle_kit(i % 3 == 2 ? Team::Red : Team::Blue);
+        const int loads = g.kits.loads;
+        g.bind_kits();
+        oneLoadPerSwap = oneLoadPerSwap && g.kits.loads - loads <= 1;
+    }
+    sc.check(g.kits.evictions > 0, "cycling past the budget evicts");
+    sc.check(!onPitchEvicted, "kits on the pitch are never evicted");
+    sc.check(oneLoadPerSwap, "a swap loads only the new kit");
+    sc.check(g.kits.used <= g.kits.budget, "cache back under budget");
+    g.kits.clear();
+    g.kits.load = nullptr; g.kits.release = nullptr; g.kits.measure = nullptr;
+    co_return;
+}
+
+struct ScenarioDef {
+    const char* name;
+    ScenarioTask (*script)(Game&, ScenarioContext&);
+};
+
+const ScenarioDef SCENARIOS[] = {
+    { "kickoff",    scenario_kickoff },
+    { "penalty",    scenario_penalty },
+    { "breakaway",  scenario_breakaway },
+    { "wall_stuck", scenario_wall_stuck },
+    { "crowd",      scenario_crowd },
+    { "ai_shot",    scenario_ai_shot },
+    { "ai_schedule", scenario_ai_schedule },
+    { "ai_tree_sync", scenario_ai_tree_sync },
+    { "ai_urgency", scenario_ai_urgency },
+    { "kit_budget", scenario_kit_budget },
+};
+
+// Chạy scenario tên `which` (hoặc "all") repeat lần; trả về số scenario fail
+int run_scenarios(const char* which, int repeat){
+    ScenarioArena arena;
+    ScenarioArena::current() = &arena;
+    pitch_field(); // bake trước, không tính vào thời gian tick
+    int ran = 0, failed = 0;
+    for(const ScenarioDef& def : SCENARIOS){
+        if(strcmp(which, "all") != 0 && strcmp(which, def.name) != 0) continue;
+        ++ran;
+        arena.peak = 0;
+        ScenarioContext result;
+        long long ticks = 0;
+        double seconds = 0.0;
+        for(int r = 0; r < std::max(1, repeat); ++r){
+            auto g = std::make_unique<Game>();
+            ScenarioContext sc;
+            ScenarioTask task = def.script(*g, sc);
+            Uint64 start = SDL_GetPerformanceCounter();
+            run_scenario(task, sc, [&](const Uint8* keys){
+                g->scriptedKeys = keys;
+                g->events.clear();
+                g->handle_kicks(keys);
+                g->update(SCENARIO_DT);
+            }, SCENARIO_MAX_TICKS);
+            seconds += (SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+            ticks += sc.tick;
+            if(r == 0 || (sc.failures && !result.failures)) result = sc;
+        }
+        if(result.failures){
+            ++failed;
+            LOG_ERROR("Scenario %-12s FAIL  %d/%d checks failed, first at %s", def.name, result.failures, result.checks, result.firstFailure);
+        } else {
+            LOG_INFO("Scenario %-12s ok    %d checks, %d ticks, %.0f ns/tick, frame arena %zu B",
+                     def.name, result.checks, result.tick, seconds * 1e9 / std::max(1LL, ticks), arena.peak);
+        }
+    }
+    ScenarioArena::current() = nullptr;
+    if(ran == 0){
+        LOG_ERROR("Unknown scenario %s", which);
+        return 1;
+    }
+    return failed;
+}
+
+// =====================================
+// Training env (--bench-envs): một trận headless = một môi trường, bước qua AsyncEnvPool
+// =====================================
+struct MatchEnv {
+    static constexpr int FRAME_SKIP = 4;                   // tick mô phỏng mỗi bước
+    static constexpr int GOALS_PER_EPISODE = 3;
+    static constexpr int MAX_EPISODE_TICKS = 60 * 60 * 3;  // 3 phút
+    static constexpr int OBS = 4 + 2 * 8;                  // bóng (x, y, vx, vy) + 8 cầu thủ (x, y)
+
+    // Hướng chạy (-1/0/1) và sút cho cầu thủ đang active của mỗi đội ([0] xanh, [1] cam)
+    struct Action {
+        int8_t moveX[2], moveY[2];
+        uint8_t kick[2];
+    };
+    struct Result {
+        int env;
+        float obs[OBS];
+        float reward;   // bàn thắng đội xanh - đội cam trong bước này
+        bool done;      // hết episode; obs đã là của episode mới
+    };
+
+    int index;
+    uint64_t seed;
+    uint64_t episode = 0;
+    int episodeTicks = 0;
+    std::unique_ptr<Game> game = std::make_unique<Game>();
+    Uint8 keys[SDL_NUM_SCANCODES] = {};
+
+    MatchEnv(int idx, uint64_t matchSeed) : index(idx), seed(matchSeed) { reset(); }
+
+    void reset(){
+        Game& g = *game;
+        g.seed_match(seed, episode++ * 2);
+        g.setup_match();
+        g.score = {};
+        g.scriptedKeys = keys;
+        g.ball.reset(g.rng.next() & 1u, g.rng);
+        episodeTicks = 0;
+    }
+
+    void step(const Action& a, Result& r){
+        Game& g = *game;
+        static constexpr SDL_Scancode KEYS[2][5] = {
+            { SDL_SCANCODE_A, SDL_SCANCODE_D, SDL_SCANCODE_W, SDL_SCANCODE_S, SDL_SCANCODE_Q },
+            { SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT, SDL_SCANCODE_UP, SDL_SCANCODE_DOWN, SDL_SCANCODE_RETURN },
+        };
+        for(int t = 0; t < 2; ++t){
+            keys[KEYS[t][0]] = a.moveX[t] < 0; keys[KEYS[t][1]] = a.moveX[t] > 0;
+            keys[KEYS[t][2]] = a.moveY[t] < 0; keys[KEYS[t][3]] = a.moveY[t] > 0;
+            keys[KEYS[t][4]] = a.kick[t] != 0;
+        }
+        int left = g.score.left, right = g.score.right;
+        for(int i = 0; i < FRAME_SKIP; ++i){
+            g.events.clear();
+            g.handle_kicks(keys);
+            keys[KEYS[0][4]] = keys[KEYS[1][4]] = 0; // sút một lần mỗi bước, không phải mỗi tick
+            g.update(1.0f / 60.0f);
+        }
+        episodeTicks += FRAME_SKIP;
+        r.env = index;
+        r.reward = (float)((g.score.left - left) - (g.score.right - right));
+        r.done = g.score.left + g.score.right >= GOALS_PER_EPISODE || episodeTicks >= MAX_EPISODE_TICKS;
+        if(r.done) reset();
+        observe(r.obs);
+    }
+
+    void observe(float* o) const {
+        const Game& g = *game;
+        *o++ = g.ball.x / SCREEN_W;  *o++ = g.ball.y / SCREEN_H;
+        *o++ = g.ball.vx / SCREEN_W; *o++ = g.ball.vy / SCREEN_H;
+        for(int i = 0; i < 8; ++i){
+            const Player* p = i < (int)g.players.size() ? &g.players[i] : nullptr;
+            *o++ = p ? p->r.x / (float)SCREEN_W : 0.0f;
+            *o++ = p ? p->r.y / (float)SCREEN_H : 0.0f;
+        }
+    }
+};
+
+// Hành động cho cả lô trận vừa xong bước: cầu thủ active của hai đội, một lần forward cho tất cả
+void policy_actions(AsyncEnvPool<MatchEnv>& pool, const MatchEnv::Result* results, int n,
+                    const MlpPolicy& policy, MatchEnv::Action* actions){
+    thread_local std::vector<float> in, out;
+    thread_local std::vector<const Player*> who;
+    in.resize((size_t)n * 2 * POLICY_INPUTS);
+    out.resize((size_t)n * 2 * POLICY_OUTPUTS);
+    who.resize((size_t)n * 2);
+    for(int k = 0; k < n; ++k){
+        const Game& g = *pool.env(results[k].env).game;
+        for(int t = 0; t < 2; ++t){
+            const Team team = t == 0 ? Team::Blue : Team::Red;
+            const Player* pick = nullptr;
+            for(const Player& p : g.players){
+                if(p.team != team) continue;
+                if(!pick || p.active){ pick = &p; if(p.active) break; }
+            }
+            who[k*2 + t] = pick;
+            g.policy_features(*pick, &in[(size_t)(k*2 + t) * POLICY_INPUTS]);
+        }
+    }
+    policy.forward(in.data(), n * 2, out.data());
+    for(int k = 0; k < n; ++k){
+        for(int t = 0; t < 2; ++t){
+            int dx, dy;
+            bool kick;
+            Game::policy_decode(*who[k*2 + t], &out[(size_t)(k*2 + t) * POLICY_OUTPUTS], dx, dy, kick);
+            actions[k].moveX[t] = (int8_t)dx;
+            actions[k].moveY[t] = (int8_t)dy;
+            actions[k].kick[t] = kick;
+        }
+    }
+}
+
+MatchEnv::Action random_action(Pcg32& rng){
+    MatchEnv::Action a;
+    for(int t = 0; t < 2; ++t){
+        a.moveX[t] = (int8_t)rng.bounded(3) - 1;
+        a.moveY[t] = (int8_t)rng.bounded(3) - 1;
+        a.kick[t] = rng.bounded(8) == 0;
+    }
+    return a;
+}
+
+// Thời gian forward mỗi mẫu theo kích thước lô, float vs int8, và sai lệch của int8
+void bench_policy(MlpPolicy& policy){
+    Pcg32 rng(1, 3);
+    for(int batch : { 1, 8, 64, 512 }){
+        std::vector<float> in((size_t)batch * policy.inputs()), outF((size_t)batch * policy.outputs()), outQ(outF.size());
+        for(float& v : in) v = rng.range(-1.0f, 1.0f);
+        double ns[2];
+        for(int mode = 0; mode < 2; ++mode){
+            policy.int8 = mode == 1;
+            std::vector<float>& out = mode ? outQ : outF;
+            int reps = std::max(1, 200000 / batch);
+            policy.forward(in.data(), batch, out.data()); // làm nóng scratch
+            Uint64 start = SDL_GetPerformanceCounter();
+            for(int r = 0; r < reps; ++r) policy.forward(in.data(), batch, out.data());
+            ns[mode] = (SDL_GetPerformanceCounter() - start) * 1e9 / (double)SDL_GetPerformanceFrequency() / ((double)reps * batch);
+        }
+        float maxErr = 0.0f, maxOut = 0.0f;
+        for(size_t i = 0; i < outF.size(); ++i){
+            maxErr = std::max(maxErr, fabsf(outF[i] - outQ[i]));
+            maxOut = std::max(maxOut, fabsf(outF[i]));
+        }
+        LOG_INFO("Policy batch %3d: float %.0f ns/sample, int8 %.0f ns/sample, int8 max error %.4f (max |out| %.3f)",
+                 batch, ns[0], ns[1], maxErr, maxOut);
+    }
+    policy.int8 = false;
+}
+
+// Thời gian một lần chạy behavior tree cho một cầu thủ (cả 8 cầu thủ là AI, bóng ở vị trí ngẫu nhiên)
+void bench_ai(const BtProgram& tree){
+    Game g;
+    prepare_scenario(g);
+    g.aiTree = tree;
+    for(auto &p : g.players) p.isAI = true;
+    Pcg32 rng(1, 5);
+    const int positions = 1024, reps = 200;
+    std::vector<PitchPoint> balls(positions);
+    for(auto &b : balls) b = { rng.range(PITCH.bounds.left(), PITCH.bounds.right()), rng.range(PITCH.bounds.top(), PITCH.bounds.bottom()) };
+    g.plan_ai(0); // làm nóng blackboard, pitch_field
+    Uint64 start = SDL_GetPerformanceCounter();
+    for(int r = 0; r < reps; ++r){
+        for(const PitchPoint& b : balls){
+            place_ball(g, b.x, b.y);
+            g.aiClock += SCENARIO_DT;
+            for(size_t i = 0; i < g.players.size(); ++i) g.plan_ai(i);
+        }
+    }
+    double sec = (SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+    double evals = (double)reps * positions * g.players.size();
+    LOG_INFO("AI tree: %zu nodes, %d slots, %.0f ns/player", tree.code.size(), tree.slots, sec * 1e9 / evals);
+}
+
+// Bầy AI đuổi bóng với số lượng tăng dần: thời gian tick và số cặp chồng nhau, có/không ORCA
+void bench_crowd(int maxAgents){
+    static const Uint8 noKeys[SDL_NUM_SCANCODES] = {};
+    constexpr int TICKS = 600;
+    pitch_field();
+    for(int n = 16; ; n = std::min(n * 4, maxAgents)){
+        for(int avoid = 1; avoid >= 0; --avoid){
+            auto g = std::make_unique<Game>();
+            prepare_scenario(*g);
+            g->players.clear();
+            add_chasers(*g, n, 1);
+            g->avoidance = avoid == 1;
+            g->scriptedKeys = noKeys;
+            place_ball(*g, PITCH.centerSpot.x, PITCH.centerSpot.y);
+            Uint64 start = SDL_GetPerformanceCounter();
+            for(int t = 0; t < TICKS; ++t){
+                g->events.clear();
+                g->update(SCENARIO_DT);
+            }
+            double sec = (SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+            LOG_INFO("Crowd %5d agents, avoidance %-3s: %8.1f us/tick, %4.0f ns/agent, %d overlapping pairs",
+                     n, avoid ? "on" : "off", sec * 1e6 / TICKS, sec * 1e9 / ((double)TICKS * n), overlapping_pairs(*g));
+        }
+        if(n >= maxAgents) break;
+    }
+}
+
+// Bầy AI chơi theo cây attacker với số lượng tăng dần: replan mỗi tick, lệch pha --ai-replan-ticks, và lệch
+// pha + ngân sách thời gian. Đo thời gian tick trung bình / tệ nhất (cú sút làm mọi AI replan cùng lúc)
+void bench_ai_schedule(int maxAgents, int replanTicks, float budgetUs){
+    static const Uint8 noKeys[SDL_NUM_SCANCODES] = {};
+    constexpr int TICKS = 600;
+    pitch_field();
+    struct Mode { const char* name; int replanTicks; float budgetUs; };
+    const Mode modes[] = {
+        { "every tick", 1, 0.0f },
+        { "staggered",  replanTicks, 0.0f },
+        { "budget",     replanTicks, budgetUs },
+    };
+    for(int n = 16; ; n = std::min(n * 4, maxAgents)){
+        for(const Mode& m : modes){
+            auto g = std::make_unique<Game>();
+            prepare_scenario(*g);
+            g->players.clear();
+            add_chasers(*g, n, 1);
+            std::string err;
+            if(!g->aiTree.compile(ATTACKER_AI_TREE, AI_LEAVES, AI_LEAF_COUNT, err, "attacker")) LOG_ERROR("AI tree: %s", err);
+            g->avoidance = false; // chỉ đo phần ra quyết định
+            g->quality.set_fixed(QUALITY_LEVEL_COUNT - 1);
+            g->aiReplanTicks = m.replanTicks;
+            g->aiSchedule.budgetUs = m.budgetUs;
+            g->scriptedKeys = noKeys;
+            place_ball(*g, PITCH.centerSpot.x, PITCH.centerSpot.y);
+            g->update(SCENARIO_DT); // làm nóng: blackboard, bộ đệm của crowd / scheduler
+            double total = 0.0, worst = 0.0;
+            for(int t = 0; t < TICKS; ++t){
+                g->events.clear();
+                Uint64 start = SDL_GetPerformanceCounter();
+                g->update(SCENARIO_DT);
+                double sec = (SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+                total += sec;
+                worst = std::max(worst, sec);
+            }
+            const AiScheduler& s = g->aiSchedule;
+            LOG_INFO("AI schedule %5d agents, %-10s: %8.1f us/tick avg, %8.1f worst, %6.1f plans/tick (%4.1f%% urgent), %llu deferred, late <= %u ticks",
+                     n, m.name, total * 1e6 / TICKS, worst * 1e6, s.plans / (double)TICKS,
+                     100.0 * s.urgentPlans / std::max<uint64_t>(s.plans, 1), (unsigned long long)s.deferred, s.maxLate);
+        }
+        if(n >= maxAgents) break;
+    }
+}
+
+// Đường chuyền / cửa sút 11 đấu 11 ở các vị trí ngẫu nhiên: cả evaluate_play, riêng kernel SIMD
+// so với bản vô hướng, và sai lệch margin giữa hai bản (log xấp xỉ)
+void bench_lanes(){
+    auto g = std::make_unique<Game>();
+    prepare_scenario(*g);
+    g->players.clear();
+    for(int i = 0; i < 22; ++i){
+        Player p(0, 0, 21, 31);
+        p.team = i < 11 ? Team::Blue : Team::Red;
+        g->players.push_back(p);
+    }
+    Pcg32 rng(1, 11);
+    const int LAYOUTS = 256, REPS = 100;
+    auto seconds_since = [](Uint64 t){ return (SDL_GetPerformanceCounter() - t) / (double)SDL_GetPerformanceFrequency(); };
+    double playSec = 0.0, simdSec = 0.0, scalarSec = 0.0;
+    float maxDiff = 0.0f;
+    float simd[LaneEvaluator::MAX_TARGETS];
+    PlayOptions o;
+    for(int l = 0; l < LAYOUTS; ++l){
+        for(auto &p : g->players){
+            place_player(p, rng.range(PITCH.bounds.left(), PITCH.bounds.right()), rng.range(PITCH.bounds.top(), PITCH.bounds.bottom()));
+        }
+        place_ball(*g, rng.range(PITCH.bounds.left(), PITCH.bounds.right()), rng.range(PITCH.bounds.top(), PITCH.bounds.bottom()));
+        Uint64 start = SDL_GetPerformanceCounter();
+        for(int r = 0; r < REPS; ++r) g->evaluate_play(Team::Blue, o);
+        playSec += seconds_since(start);
+
+        LaneEvaluator& lanes = g->lanes;
+        const float bx = ball_cx(*g), by = ball_cy(*g);
+        start = SDL_GetPerformanceCounter();
+        for(int r = 0; r < REPS; ++r) lanes.evaluate(bx, by, Game::lane_params());
+        simdSec += seconds_since(start);
+        std::copy(lanes.margin, lanes.margin + lanes.targets, simd);
+        start = SDL_GetPerformanceCounter();
+        for(int r = 0; r < REPS; ++r) lanes.evaluate_reference(bx, by, Game::lane_params());
+        scalarSec += seconds_since(start);
+        for(int k = 0; k < lanes.targets; ++k){
+            if(std::isfinite(simd[k])) maxDiff = std::max(maxDiff, fabsf(simd[k] - lanes.margin[k]));
+        }
+    }
+    const double n = (double)LAYOUTS * REPS;
+    LOG_INFO("Lanes 11v11 (%d targets x %d opponents): evaluate_play %.2f us, kernel SIMD %.2f us, scalar %.2f us, max margin diff %.5f s",
+             g->lanes.targets, g->lanes.opponents, playSec * 1e6 / n, simdSec * 1e6 / n, scalarSec * 1e6 / n, maxDiff);
+}
+
+// So sánh bước đồng bộ (chờ cả lô) với bất đồng bộ (nhận trận xong trước, gửi lại ngay).
+// Có policy: hành động của mọi trận trong lô lấy từ một lần forward, không thì random
+void bench_envs(int envCount, int threads, int steps, uint64_t seed, const MlpPolicy* policy){
+    envCount = std::max(1, envCount);
+    std::vector<std::unique_ptr<MatchEnv>> envs;
+    for(int i = 0; i < envCount; ++i) envs.push_back(std::make_unique<MatchEnv>(i, seed + (uint64_t)i));
+    pitch_field();
+    AsyncEnvPool<MatchEnv> pool(std::move(envs), threads);
+    Pcg32 rng(seed, 99);
+    std::vector<MatchEnv::Action> actions(envCount);
+    std::vector<MatchEnv::Result> results(envCount);
+    std::vector<MatchEnv::Action> next(envCount);
+    auto seconds_since = [](Uint64 t){ return (SDL_GetPerformanceCounter() - t) / (double)SDL_GetPerformanceFrequency(); };
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    long long done = 0;
+    int episodes = 0;
+    int n = 0;
+    for(auto &a : actions) a = random_action(rng);
+    while(done < steps){
+        n = pool.step_all(actions.data(), results.data());
+        done += n;
+        for(int i = 0; i < n; ++i) episodes += results[i].done;
+        if(policy) policy_actions(pool, results.data(), n, *policy, next.data());
+        for(int i = 0; i < n; ++i) actions[results[i].env] = policy ? next[i] : random_action(rng);
+    }
+    double syncSec = seconds_since(start);
+    LOG_INFO("Envs sync : %d envs, %d threads, %lld steps, %.0f steps/s, %d episodes, actions %s",
+             envCount, pool.threads(), done, done / syncSec, episodes, policy ? (policy->int8 ? "int8 MLP" : "float MLP") : "random");
+
+    // Async: nhận ít nhất 1/4 lô rồi gửi lại ngay những trận đó
+    start = SDL_GetPerformanceCounter();
+    done = 0; episodes = 0;
+    long long batches = 0;
+    for(int i = 0; i < envCount; ++i) pool.submit(i, random_action(rng));
+    while(done < steps){
+        n = pool.recv(results.data(), envCount, std::max(1, envCount / 4));
+        done += n; ++batches;
+        if(policy) policy_actions(pool, results.data(), n, *policy, next.data());
+        for(int i = 0; i < n; ++i){
+            episodes += results[i].done;
+            pool.submit(results[i].env, policy ? next[i] : random_action(rng));
+        }
+    }
+    while(pool.in_flight() > 0) pool.recv(results.data(), envCount, pool.in_flight());
+    double asyncSec = seconds_since(start);
+    LOG_INFO("Envs async: %d envs, %d threads, %lld steps, %.0f steps/s, %d episodes, %.1f results/recv",
+             envCount, pool.threads(), done, done / asyncSec, episodes, done / (double)std::max(1LL, batches));
+}
+
 int main(int argc, char** argv){
-    srand((unsigned int)SDL_GetTicks());
+    // --seed N: chạy lại trận với cùng chuỗi random
+    // --software: dùng software renderer + vẽ lại từng vùng bẩn (máy không có GPU)
+    // --cpu-raster: tự rasterize sprite trên CPU (SIMD, đa luồng)
+    // --record FILE: ghi replay khi chơi, lưu lúc thoát
+    // --export FILE OUT.y4m [--export-size WxH] [--export-fps N]: dựng replay thành video
+    // --kits HOME,AWAY: áo đấu hai đội (blue, red, white, green, special)
+    // --kit-budget-kb N: bộ nhớ texture tối đa cho áo đấu trước khi evict
+    // --svg-art: rasterize sân/cầu môn từ SVG đúng độ phân giải (cache trong svg_cache/)
+    // --hot-reload: theo dõi file ảnh/font, sửa xong là thấy ngay không cần khởi động lại
+    // --log-level debug|info|warn|error|off: mức log tối thiểu (mặc định info)
+    // --metrics-port N: số liệu Prometheus ở http://127.0.0.1:N/metrics
+    // --quality auto|minimal|low|medium|high|full: mức chi tiết (mặc định auto, tự hạ khi tụt fps)
+    // --scenario NAME|all [--scenario-repeat N]: chạy kịch bản headless (kickoff, penalty, breakaway, wall_stuck, crowd, ai_shot, ai_schedule, ai_tree_sync, ai_urgency, kit_budget)
+    // --bench-envs N [--env-threads T] [--env-steps S]: đo bước env đồng bộ vs bất đồng bộ (training)
+    // --policy FILE [--policy-int8]: AI (và --bench-envs) dùng MLP từ file; --policy-init FILE: ghi MLP ngẫu nhiên
+    // --bench-policy: đo forward float vs int8 của policy (mặc định MLP ngẫu nhiên)
+    // --ai-tree FILE: behavior tree của AI (mặc định ../data/ai/default.bt, không có thì cây dựng sẵn)
+    // --bench-ai: đo thời gian chạy behavior tree mỗi cầu thủ
+    // --bench-lanes: đo đánh giá đường chuyền / cửa sút 11 đấu 11
+    // --bench-crowd N: bầy tới N AI đuổi bóng, thời gian tick có/không tránh va chạm; --no-avoidance: tắt
+    // --ai-budget-us N: thời gian replan AI tối đa mỗi tick (mặc định 1000, 0 = không giới hạn)
+    // --ai-replan-ticks N: mỗi AI replan N tick một lần, lệch pha (mặc định 4; quality thấp giãn thêm)
+    // --bench-ai-schedule N: bầy tới N AI, replan mỗi tick / lệch pha / lệch pha + ngân sách
+    uint64_t seed = SDL_GetPerformanceCounter();
+    bool software = false, cpuRaster = false, svgArt = false, hotReload = false;
+    const char* recordPath = nullptr;
+    const char* exportIn = nullptr;
+    const char* exportOut = nullptr;
+    int exportW = SCREEN_W, exportH = SCREEN_H, exportFps = 60;
+    int homeKit = 0, awayKit = 1;
+    size_t kitBudget = KitCache::DEFAULT_BUDGET;
+    int metricsPort = 0;
+    int qualityLevel = -1; // -1 = auto
+    const char* scenario = nullptr;
+    int scenarioRepeat = 1;
+    int benchEnvs = 0, envThreads = 0, envSteps = 100000;
+    const char* policyPath = nullptr;
+    const char* policyInit = nullptr;
+    bool policyInt8 = false, benchPolicy = false;
+    const char* aiTreeFile = nullptr;
+    bool benchAi = false, avoidance = true, benchLanes = false;
+    int benchCrowd = 0, benchSchedule = 0;
+    float aiBudgetUs = 1000.0f;
+    int aiReplanTicks = 4;
+    for(int i = 1; i < argc; ++i){
+        if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], nullptr, 10);
+        else if(strcmp(argv[i], "--software") == 0) software = true;
+        else if(strcmp(argv[i], "--cpu-raster") == 0) cpuRaster = true;
+        else if(strcmp(argv[i], "--svg-art") == 0){
+            svgArt = SvgCache::SUPPORTED;
+            if(!svgArt) LOG_WARN("--svg-art needs SDL_image 2.6 or newer, using the PNG art");
+        }
+        else if(strcmp(argv[i], "--hot-reload") == 0) hotReload = true;
+        else if(strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) metricsPort = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--quality") == 0 && i + 1 < argc){
+            const char* name = argv[++i];
+            int found = strcmp(name, "auto") == 0 ? -1 : -2;
+            for(int q = 0; q < QUALITY_LEVEL_COUNT; ++q) if(strcmp(name, QUALITY_LEVELS[q].name) == 0) found = q;
+            if(found == -2) LOG_WARN("Unknown quality %s", name);
+            else qualityLevel = found;
+        }
+        else if(strcmp(argv[i], "--log-level") == 0 && i + 1 < argc){
+            LogLevel level;
+            if(logging::parse_level(argv[++i], level)) logging::set_level(level);
+            else LOG_WARN("Unknown log level %s", argv[i]);
+        }
+        else if(strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if(strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) scenario = argv[++i];
+        else if(strcmp(argv[i], "--scenario-repeat") == 0 && i + 1 < argc) scenarioRepeat = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--bench-envs") == 0 && i + 1 < argc) benchEnvs = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--env-threads") == 0 && i + 1 < argc) envThreads = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--env-steps") == 0 && i + 1 < argc) envSteps = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--policy") == 0 && i + 1 < argc) policyPath = argv[++i];
+        else if(strcmp(argv[i], "--policy-init") == 0 && i + 1 < argc) policyInit = argv[++i];
+        else if(strcmp(argv[i], "--policy-int8") == 0) policyInt8 = true;
+        else if(strcmp(argv[i], "--bench-policy") == 0) benchPolicy = true;
+        else if(strcmp(argv[i], "--ai-tree") == 0 && i + 1 < argc) aiTreeFile = argv[++i];
+        else if(strcmp(argv[i], "--bench-ai") == 0) benchAi = true;
+        else if(strcmp(argv[i], "--bench-crowd") == 0 && i + 1 < argc) benchCrowd = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--no-avoidance") == 0) avoidance = false;
+        else if(strcmp(argv[i], "--bench-lanes") == 0) benchLanes = true;
+        else if(strcmp(argv[i], "--ai-budget-us") == 0 && i + 1 < argc) aiBudgetUs = (float)atof(argv[++i]);
+        else if(strcmp(argv[i], "--ai-replan-ticks") == 0 && i + 1 < argc) aiReplanTicks = std::max(1, atoi(argv[++i]));
+        else if(strcmp(argv[i], "--bench-ai-schedule") == 0 && i + 1 < argc) benchSchedule = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--export") == 0 && i + 2 < argc){ exportIn = argv[++i]; exportOut = argv[++i]; }
+        else if(strcmp(argv[i], "--export-size") == 0 && i + 1 < argc) sscanf(argv[++i], "%dx%d", &exportW, &exportH);
+        else if(strcmp(argv[i], "--export-fps") == 0 && i + 1 < argc) exportFps = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--kit-budget-kb") == 0 && i + 1 < argc) kitBudget = (size_t)atoi(argv[++i]) * 1024;
+        else if(strcmp(argv[i], "--kits") == 0 && i + 1 < argc){
+            char home[32] = "", away[32] = "";
+            sscanf(argv[++i], "%31[^,],%31s", home, away);
+            int h = kit_by_name(home), a = kit_by_name(away);
+            if(h < 0 || a < 0 || h == a) LOG_WARN("Ignoring --kits %s (need two different kits)", argv[i]);
+            else { homeKit = h; awayKit = a; }
+        }
+    }
+
+    if(policyInit){
+        MlpPolicy init = MlpPolicy::random({ POLICY_INPUTS, 64, 64, POLICY_OUTPUTS }, seed);
+        if(!init.save(policyInit)){ LOG_ERROR("Could not write policy %s", policyInit); return 1; }
+        LOG_INFO("Random policy written to %s", policyInit);
+        return 0;
+    }
+    MlpPolicy policy;
+    if(policyPath){
+        if(!policy.load(policyPath) || policy.inputs() != POLICY_INPUTS || policy.outputs() != POLICY_OUTPUTS){
+            LOG_ERROR("Could not load policy %s (need %d inputs, %d outputs)", policyPath, POLICY_INPUTS, POLICY_OUTPUTS);
+            return 1;
+        }
+        LOG_INFO("Policy %s: %zu layers", policyPath, policy.layers.size());
+    }
+    if(benchPolicy){
+        if(!policyPath) policy = MlpPolicy::random({ POLICY_INPUTS, 64, 64, POLICY_OUTPUTS }, seed);
+        bench_policy(policy);
+        return 0;
+    }
+    policy.int8 = policyInt8;
+    const MlpPolicy* aiPolicy = policyPath ? &policy : nullptr;
+
+    // Cây AI: file chỉ định phải nạp được; file mặc định thì có mới dùng
+    BtProgram aiTree = default_ai_tree();
+    std::string aiTreePath;
+    if(!aiTreeFile && std::filesystem::exists(DEFAULT_AI_TREE_FILE)) aiTreeFile = DEFAULT_AI_TREE_FILE;
+    if(aiTreeFile){
+        std::string err;
+        if(!aiTree.load(aiTreeFile, AI_LEAVES, AI_LEAF_COUNT, err)){
+            LOG_ERROR("AI tree: %s", err);
+            return 1;
+        }
+        aiTreePath = aiTreeFile;
+        LOG_INFO("AI tree %s: %zu nodes, %d blackboard slots", aiTreeFile, aiTree.code.size(), aiTree.slots);
+    }
+    if(benchAi){
+        bench_ai(aiTree);
+        return 0;
+    }
+    if(benchLanes){
+        bench_lanes();
+        return 0;
+    }
+    if(benchCrowd > 0){
+        bench_crowd(benchCrowd);
+        return 0;
+    }
+    if(benchSchedule > 0){
+        bench_ai_schedule(benchSchedule, aiReplanTicks, aiBudgetUs);
+        return 0;
+    }
+
+    if(scenario) return run_scenarios(scenario, scenarioRepeat) == 0 ? 0 : 1;
+    if(benchEnvs > 0){
+        bench_envs(benchEnvs, envThreads, envSteps, seed, aiPolicy);
+        return 0;
+    }
+
+    if(exportIn){
+        Replay rp;
+        if(!rp.load(exportIn)){ LOG_ERROR("Could not read replay %s", exportIn); return 1; }
+        Game game;
+        game.seed_match(rp.seed);
+        game.cpuRaster = true;   // export dùng CPU rasterizer (cần bản pixel của texture)
+        game.hiddenWindow = true;
+        game.homeKit = homeKit; game.awayKit = awayKit;
+        game.kits.budget = kitBudget;
+        game.svgArt = svgArt;
+        game.artScale = std::min(exportW / (float)SCREEN_W, exportH / (float)SCREEN_H);
+        if(!game.init()) return 1;
+        bool ok = game.export_replay(rp, exportOut, exportW, exportH, exportFps);
+        game.cleanup();
+        return ok ? 0 : 1;
+    }
+
     Game game;
+    game.seed_match(seed);
+    game.softwareRender = software;
+    game.cpuRaster = cpuRaster;
+    game.recordPath = recordPath;
+    game.homeKit = homeKit; game.awayKit = awayKit;
+    game.kits.budget = kitBudget;
+    game.svgArt = svgArt;
+    game.hotReload = hotReload;
+    game.policy = aiPolicy;
+    game.aiTree = aiTree;
+    game.aiTreePath = aiTreePath;
+    game.avoidance = avoidance;
+    game.aiSchedule.budgetUs = aiBudgetUs;
+    game.aiReplanTicks = aiReplanTicks;
+    if(qualityLevel >= 0) game.quality.set_fixed(qualityLevel);
     if(!game.init()) return 1;
+    game.apply_quality();
+    LOG_INFO("Match seed: %llu", (unsigned long long)seed);
+    if(metricsPort > 0) game.metricsServer.start(game.metrics.registry, metricsPort);
+    game.metrics.matchesRunning.set(1);
 
     Uint64 NOW = SDL_GetPerformanceCounter();
     Uint64 LAST = 0;
@@ -1064,11 +3419,26 @@ int main(int argc, char** argv){
         float dt = (float)(deltaTime / 1000.0);
 
         game.handle_input();
+        game.poll_assets();
+        Uint64 tickStart = SDL_GetPerformanceCounter();
         game.update(dt);
-        game.render();
-
-        // cap to ~60fps (optional) - SDL_Renderer with vsync may already cap
-        SDL_Delay(1);
+        double tickSec = (SDL_GetPerformanceCounter() - tickStart) / (double)SDL_GetPerformanceFrequency();
+        game.metrics.tick.observe(tickSec);
+        bool presented = game.render_if_changed();
+        if(presented) game.govern(tickSec);
+
+        if(game.window_hidden()){
+            SDL_Delay(100);                    // thu nhỏ/ẩn: chạy ~10 lần/giây, không vẽ
+        } else if(!presented){
+            SDL_WaitEventTimeout(nullptr, 8);  // không có gì mới để vẽ: ngủ tới khi có input
+        } else if(game.softwareRender){
+            // window surface không có vsync: tự giới hạn ~60fps
+            double frameMs = (SDL_GetPerformanceCounter() - NOW) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+            if(frameMs < 16.0) SDL_Delay((Uint32)(16.0 - frameMs));
+        } else {
+            // cap to ~60fps (optional) - SDL_Renderer with vsync may already cap
+            SDL_Delay(1);
+        }
     }
 
     game.cleanup();